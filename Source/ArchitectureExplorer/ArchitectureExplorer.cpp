@@ -4,3 +4,9 @@
 #include "Modules/ModuleManager.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, ArchitectureExplorer, "ArchitectureExplorer" );
+
+DEFINE_LOG_CATEGORY(LogVRLocomotion);
+
+CSV_DEFINE_CATEGORY(VRLocomotion, true);
+
+const FName TeleportProxyTag(TEXT("TeleportProxy"));
@@ -3,4 +3,24 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogVRLocomotion, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("VRLocomotion"), STATGROUP_VRLocomotion, STATCAT_Advanced);
+
+CSV_DECLARE_CATEGORY_EXTERN(VRLocomotion);
+
+// "Teleport" trace channel (DefaultEngine.ini). Nothing blocks it but the proxies made by GenerateTeleportProxies.
+#define ECC_Teleport ECC_GameTraceChannel1
+
+// Tags the actor holding a level's teleport proxies
+extern const FName TeleportProxyTag;
+
+// Times a locomotion scope for stat VRLocomotion, the CSV profiler and Unreal Insights at once
+#define VR_LOCOMOTION_SCOPE(Stat, Name) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	CSV_SCOPED_TIMING_STAT(VRLocomotion, Name); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(VRLocomotion_##Name)
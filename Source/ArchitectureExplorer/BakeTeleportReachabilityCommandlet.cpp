@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BakeTeleportReachabilityCommandlet.h"
+
+#include "ArchitectureExplorer.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Parse.h"
+#include "NavMesh/NavMeshBoundsVolume.h"
+#include "NavigationSystem.h"
+#include "TeleportReachabilityField.h"
+#include "UObject/Package.h"
+
+UBakeTeleportReachabilityCommandlet::UBakeTeleportReachabilityCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UBakeTeleportReachabilityCommandlet::Main(const FString& Params)
+{
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Usage: -run=BakeTeleportReachability -Map=/Game/MainMap [-CellSize=25] [-CellHeight=50]"));
+		return 1;
+	}
+	float CellSize = 25.f;
+	float CellHeight = 50.f;
+	FParse::Value(*Params, TEXT("CellSize="), CellSize);
+	FParse::Value(*Params, TEXT("CellHeight="), CellHeight);
+	if (CellSize <= 0.f || CellHeight <= 0.f)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("CellSize and CellHeight must be positive"));
+		return 1;
+	}
+
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (!World)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.InitializeScenes(false)
+			.AllowAudioPlayback(false)
+			.RequiresHitProxies(false)
+			.CreatePhysicsScene(true)
+			.CreateNavigation(true)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(false)
+			.SetTransactional(false)
+			.CreateFXSystem(false));
+	}
+	World->UpdateWorldComponents(true, false);
+
+	UNavigationSystemV1* NavSystem = UNavigationSystemV1::GetCurrent(World);
+	if (!NavSystem)
+	{
+		FNavigationSystem::AddNavigationSystemToWorld(*World, FNavigationSystemRunMode::EditorMode);
+		NavSystem = UNavigationSystemV1::GetCurrent(World);
+	}
+	if (!NavSystem || !NavSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate))
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("%s has no nav mesh to sample"), *MapName);
+		World->RemoveFromRoot();
+		return 1;
+	}
+
+	FBox Bounds(ForceInit);
+	for (TActorIterator<ANavMeshBoundsVolume> It(World); It; ++It)
+	{
+		Bounds += It->GetComponentsBoundingBox(true);
+	}
+	if (!Bounds.IsValid)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("%s has no nav mesh bounds volume"), *MapName);
+		World->RemoveFromRoot();
+		return 1;
+	}
+
+	FTeleportReachabilityField::FHeader Header;
+	Header.Magic = FTeleportReachabilityField::FileMagic;
+	Header.Version = FTeleportReachabilityField::FileVersion;
+	Header.Origin = Bounds.Min;
+	Header.CellSize = CellSize;
+	Header.CellHeight = CellHeight;
+	Header.NavMeshHash = FTeleportReachabilityField::HashNavMesh(World);
+	const FVector Size = Bounds.GetSize();
+	Header.Dims = FIntVector(
+		FMath::Max(FMath::CeilToInt(Size.X / CellSize), 1),
+		FMath::Max(FMath::CeilToInt(Size.Y / CellSize), 1),
+		FMath::Max(FMath::CeilToInt(Size.Z / CellHeight), 1));
+
+	if (Header.Dims.Z > MAX_uint16)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("%s is %d cells high, at most %d fit; raise CellHeight"), *MapName, Header.Dims.Z, int32(MAX_uint16));
+		World->RemoveFromRoot();
+		return 1;
+	}
+
+	typedef FTeleportReachabilityField::FLayer FLayer;
+	const int32 TileSize = FTeleportReachabilityField::TileSize;
+	const FIntPoint NumTiles = FTeleportReachabilityField::GetNumTiles(Header.Dims);
+	const int64 NumCells = int64(Header.Dims.X) * Header.Dims.Y * Header.Dims.Z;
+	if (int64(sizeof(Header)) + int64(NumTiles.X) * NumTiles.Y * int64(sizeof(uint32)) > MAX_int32)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("%s needs %d x %d tiles, too many to index; raise CellSize"), *MapName, NumTiles.X, NumTiles.Y);
+		World->RemoveFromRoot();
+		return 1;
+	}
+
+	TArray<uint32> Tiles;
+	TArray<uint32> Columns;
+	TArray<FLayer> Layers;
+	Tiles.Init(FTeleportReachabilityField::EmptyTile, NumTiles.X * NumTiles.Y);
+
+	UE_LOG(LogVRLocomotion, Display, TEXT("Sampling %s into %d x %d x %d cells"), *MapName, Header.Dims.X, Header.Dims.Y, Header.Dims.Z);
+
+	// Each cell is a query box of exactly its own size, so every hit lies inside the cell
+	const FVector QueryExtent(CellSize * 0.5f, CellSize * 0.5f, CellHeight * 0.5f);
+	for (int32 TileY = 0; TileY < NumTiles.Y; TileY++)
+	{
+		for (int32 TileX = 0; TileX < NumTiles.X; TileX++)
+		{
+			const int32 TileFirstLayer = Layers.Num();
+			const int32 TileFirstColumn = Columns.Num();
+			for (int32 Y = TileY * TileSize; Y < (TileY + 1) * TileSize; Y++)
+			{
+				for (int32 X = TileX * TileSize; X < (TileX + 1) * TileSize; X++)
+				{
+					Columns.Add(uint32(Layers.Num()));
+					if (X >= Header.Dims.X || Y >= Header.Dims.Y)
+					{
+						continue;
+					}
+					for (int32 Z = 0; Z < Header.Dims.Z; Z++)
+					{
+						const float CellBottom = Header.Origin.Z + Z * CellHeight;
+						const FVector CellCenter = Header.Origin + FVector((X + 0.5f) * CellSize, (Y + 0.5f) * CellSize, (Z + 0.5f) * CellHeight);
+						FNavLocation NavLocation;
+						if (NavSystem->ProjectPointToNavigation(CellCenter, OUT NavLocation, QueryExtent))
+						{
+							Layers.Add({ uint16(Z), FTeleportReachabilityField::EncodeCell(NavLocation.Location.Z - CellBottom, CellHeight), 0 });
+						}
+					}
+				}
+			}
+			Columns.Add(uint32(Layers.Num()));
+
+			if (Layers.Num() == TileFirstLayer)
+			{
+				// Nothing reachable, the tile stays empty
+				Columns.SetNum(TileFirstColumn, false);
+				continue;
+			}
+			Tiles[TileX + NumTiles.X * TileY] = uint32(TileFirstColumn / FTeleportReachabilityField::TileColumns);
+
+			const int64 NumBytes = int64(sizeof(Header)) + Tiles.Num() * int64(sizeof(uint32)) + Columns.Num() * int64(sizeof(uint32)) + Layers.Num() * int64(sizeof(FLayer));
+			if (NumBytes > MAX_int32)
+			{
+				UE_LOG(LogVRLocomotion, Error, TEXT("The field for %s would be larger than %d bytes; raise CellSize or CellHeight"), *MapName, MAX_int32);
+				World->RemoveFromRoot();
+				return 1;
+			}
+		}
+	}
+
+	Header.NumTiles = uint32(Columns.Num() / FTeleportReachabilityField::TileColumns);
+	Header.NumLayers = uint32(Layers.Num());
+	TArray<uint8> Bytes;
+	Bytes.Append(reinterpret_cast<const uint8*>(&Header), int32(sizeof(Header)));
+	Bytes.Append(reinterpret_cast<const uint8*>(Tiles.GetData()), Tiles.Num() * int32(sizeof(uint32)));
+	Bytes.Append(reinterpret_cast<const uint8*>(Columns.GetData()), Columns.Num() * int32(sizeof(uint32)));
+	Bytes.Append(reinterpret_cast<const uint8*>(Layers.GetData()), Layers.Num() * int32(sizeof(FLayer)));
+	const int64 NumReachable = Layers.Num();
+
+	const FString Filename = FTeleportReachabilityField::GetFilenameForLevel(FPackageName::GetShortName(MapName));
+	const bool bSaved = FFileHelper::SaveArrayToFile(Bytes, *Filename);
+	World->RemoveFromRoot();
+	if (!bSaved)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not write %s"), *Filename);
+		return 1;
+	}
+
+	UE_LOG(LogVRLocomotion, Display, TEXT("Wrote %s: %lld of %lld cells reachable, %lld bytes"), *Filename, NumReachable, NumCells, int64(Bytes.Num()));
+	return 0;
+}
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "CoreMinimal.h"
+
+#include "BakeTeleportReachabilityCommandlet.generated.h"
+
+/**
+ * Samples the nav mesh of a level into a teleport reachability field (see FTeleportReachabilityField).
+ * The sampled volume is the union of the level's nav mesh bounds volumes. Fails when the field would not fit
+ * in 2 GB or the volume is more than 65535 cells high. The field is only used while the level's nav mesh still
+ * matches the one it was sampled from, so rerun this after rebuilding navigation.
+ *
+ * Usage: UE4Editor-Cmd ArchitectureExplorer.uproject -run=BakeTeleportReachability -Map=/Game/MainMap [-CellSize=25] [-CellHeight=50]
+ */
+UCLASS()
+class ARCHITECTUREEXPLORER_API UBakeTeleportReachabilityCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UBakeTeleportReachabilityCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
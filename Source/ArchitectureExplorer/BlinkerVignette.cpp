@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "BlinkerVignette.h"
+
+#include "ArchitectureExplorer.h"
+#include "Camera/CameraComponent.h"
+#include "Curves/CurveFloat.h"
+#include "Engine/Engine.h"
+#include "IHeadMountedDisplay.h"
+#include "IXRTrackingSystem.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Blinker Parameter Pushes"), STAT_BlinkerParameterPushes, STATGROUP_VRLocomotion);
+
+namespace
+{
+	const FName RadiusParameterName(TEXT("Radius"));
+	const FName CenterParameterName(TEXT("Center"));
+}
+
+void FBlinkerVignette::Initialize(UMaterialInstanceDynamic* InMaterial, const UCurveFloat* RadiusVsVelocity, const UCameraComponent* Camera)
+{
+	Material = InMaterial;
+	BakeRadiusTable(RadiusVsVelocity);
+
+	PushedRadius = GetRadiusForSpeed(0.f);
+	PushedCenter = FVector2D(0.5f, 0.5f);
+	RadiusParameterIndex = INDEX_NONE;
+	CenterParameterIndex = INDEX_NONE;
+	if (Material)
+	{
+		// Looked up by name once here, by index from then on
+		if (!Material->InitializeScalarParameterAndGetIndex(RadiusParameterName, PushedRadius, OUT RadiusParameterIndex))
+		{
+			RadiusParameterIndex = INDEX_NONE;
+		}
+		if (!Material->InitializeVectorParameterAndGetIndex(CenterParameterName, FLinearColor(PushedCenter.X, PushedCenter.Y, 0.f), OUT CenterParameterIndex))
+		{
+			CenterParameterIndex = INDEX_NONE;
+		}
+	}
+
+	// The HMD knows its real per eye field of view, the camera's is only a fallback
+	float HorizontalFov = Camera ? Camera->FieldOfView : 90.f;
+	float VerticalFov = 0.f;
+	if (GEngine && GEngine->XRSystem.IsValid() && GEngine->XRSystem->GetHMDDevice())
+	{
+		GEngine->XRSystem->GetHMDDevice()->GetFieldOfView(OUT HorizontalFov, OUT VerticalFov);
+	}
+	TanHalfFov.X = FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(HorizontalFov, 1.f, 170.f) * 0.5f));
+	TanHalfFov.Y = VerticalFov > 0.f
+		? FMath::Tan(FMath::DegreesToRadians(FMath::Clamp(VerticalFov, 1.f, 170.f) * 0.5f))
+		: TanHalfFov.X / FMath::Max(Camera ? Camera->AspectRatio : 1.f, KINDA_SMALL_NUMBER);
+}
+
+void FBlinkerVignette::Update(const FQuat& CameraRotation, const FVector& Velocity)
+{
+	if (!Material)
+	{
+		return;
+	}
+
+	const float Radius = GetRadiusForSpeed(Velocity.Size() / 100);
+	if (RadiusParameterIndex != INDEX_NONE && !FMath::IsNearlyEqual(Radius, PushedRadius, RadiusThreshold))
+	{
+		Material->SetScalarParameterByIndex(RadiusParameterIndex, Radius);
+		PushedRadius = Radius;
+		++ParameterPushes;
+		INC_DWORD_STAT(STAT_BlinkerParameterPushes);
+	}
+
+	const FVector MovementDirection = Velocity.GetSafeNormal();
+	const FVector2D Center = MovementDirection.IsNearlyZero()
+		? FVector2D(0.5f, 0.5f)
+		: GetCenter(CameraRotation.UnrotateVector(MovementDirection));
+	if (CenterParameterIndex != INDEX_NONE && !Center.Equals(PushedCenter, CenterThreshold))
+	{
+		Material->SetVectorParameterByIndex(CenterParameterIndex, FLinearColor(Center.X, Center.Y, 0.f));
+		PushedCenter = Center;
+		++ParameterPushes;
+		INC_DWORD_STAT(STAT_BlinkerParameterPushes);
+	}
+}
+
+float FBlinkerVignette::GetRadiusForSpeed(float SpeedMeters) const
+{
+	if (RadiusTable.Num() < 2)
+	{
+		return RadiusTable.Num() > 0 ? RadiusTable[0] : DefaultRadius;
+	}
+
+	// Curves hold their end values outside their range, and so does the table
+	const float Position = FMath::Clamp((SpeedMeters - TableMinSpeed) * TableSpeedToIndex, 0.f, float(RadiusTable.Num() - 1));
+	const int32 Index = FMath::Min(FMath::FloorToInt(Position), RadiusTable.Num() - 2);
+	return FMath::Lerp(RadiusTable[Index], RadiusTable[Index + 1], Position - Index);
+}
+
+// Camera space is X forward, Y right, Z up. A direction projects to the screen at its slope over the
+// tangent of half the field of view, which is all ProjectWorldLocationToScreen works out for a point
+// far along it.
+FVector2D FBlinkerVignette::GetCenter(const FVector& CameraSpaceDirection) const
+{
+	// Moving backwards, the vignette centers on where we are moving away from
+	const FVector Direction = CameraSpaceDirection.X < 0.f ? -CameraSpaceDirection : CameraSpaceDirection;
+	const float Forward = FMath::Max(Direction.X, KINDA_SMALL_NUMBER);
+
+	const float U = 0.5f + 0.5f * (Direction.Y / Forward) / TanHalfFov.X;
+	const float V = 0.5f - 0.5f * (Direction.Z / Forward) / TanHalfFov.Y;
+	return FVector2D(FMath::Clamp(U, 0.f, 1.f), FMath::Clamp(V, 0.f, 1.f));
+}
+
+void FBlinkerVignette::BakeRadiusTable(const UCurveFloat* RadiusVsVelocity)
+{
+	RadiusTable.Reset();
+	TableMinSpeed = 0.f;
+	TableSpeedToIndex = 0.f;
+	if (!RadiusVsVelocity)
+	{
+		RadiusTable.Add(DefaultRadius);
+		return;
+	}
+
+	float MinSpeed = 0.f;
+	float MaxSpeed = 0.f;
+	RadiusVsVelocity->GetTimeRange(OUT MinSpeed, OUT MaxSpeed);
+
+	const int32 NumEntries = FMath::Max(RadiusTableSize, 2);
+	RadiusTable.SetNumUninitialized(NumEntries);
+	for (int32 i = 0; i < NumEntries; i++)
+	{
+		RadiusTable[i] = RadiusVsVelocity->GetFloatValue(FMath::Lerp(MinSpeed, MaxSpeed, float(i) / (NumEntries - 1)));
+	}
+
+	TableMinSpeed = MinSpeed;
+	TableSpeedToIndex = MaxSpeed > MinSpeed ? (NumEntries - 1) / (MaxSpeed - MinSpeed) : 0.f;
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UCameraComponent;
+class UCurveFloat;
+class UMaterialInstanceDynamic;
+
+/**
+ * Drives the comfort vignette ("blinker") post process material. The radius comes from RadiusVsVelocity baked
+ * into a lookup table, and the center is the movement direction projected analytically in camera space, so
+ * no viewport query or world-to-screen projection runs per frame. Both parameters are bound by index once and
+ * only pushed to the material when they move beyond a threshold.
+ */
+class FBlinkerVignette
+{
+public:
+	// Binds the Radius and Center parameters of Material and bakes RadiusVsVelocity. Material is not owned.
+	void Initialize(UMaterialInstanceDynamic* InMaterial, const UCurveFloat* RadiusVsVelocity, const UCameraComponent* Camera);
+
+	// Updates the vignette for the camera's orientation and the character's velocity (cm/s)
+	void Update(const FQuat& CameraRotation, const FVector& Velocity);
+
+	// Radius for a speed in m/s, read from the baked table
+	float GetRadiusForSpeed(float SpeedMeters) const;
+
+	// Screen UV where the movement direction (or its opposite when moving backwards) lies
+	FVector2D GetCenter(const FVector& CameraSpaceDirection) const;
+
+	uint64 GetParameterPushes() const { return ParameterPushes; }
+
+public: // tuning
+	// Entries in the radius lookup table
+	int32 RadiusTableSize = 64;
+
+	// Radius change that is pushed to the material
+	float RadiusThreshold = 0.005f;
+
+	// Center change (UV) that is pushed to the material
+	float CenterThreshold = 0.002f;
+
+	// Radius used when there is no curve, large enough to keep the vignette off screen
+	float DefaultRadius = 2.f;
+
+private:
+	void BakeRadiusTable(const UCurveFloat* RadiusVsVelocity);
+
+	UMaterialInstanceDynamic* Material = nullptr;
+	int32 RadiusParameterIndex = INDEX_NONE;
+	int32 CenterParameterIndex = INDEX_NONE;
+	float PushedRadius = 0.f;
+	FVector2D PushedCenter = FVector2D(0.5f, 0.5f);
+
+	TArray<float> RadiusTable;
+	float TableMinSpeed = 0.f;
+	float TableSpeedToIndex = 0.f;
+
+	// Tangents of half the horizontal and vertical field of view
+	FVector2D TanHalfFov = FVector2D(1.f, 1.f);
+
+	uint64 ParameterPushes = 0;
+};
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ClimbSolver.h"
+
+void FClimbSolver::Grab(int32 HandIndex, const FVector& HandLocation)
+{
+	check(HandIndex >= 0 && HandIndex < MaxHands);
+	Anchors[HandIndex] = HandLocation;
+	ActiveMask |= 1 << HandIndex;
+}
+
+void FClimbSolver::Release(int32 HandIndex)
+{
+	check(HandIndex >= 0 && HandIndex < MaxHands);
+	ActiveMask &= ~(1 << HandIndex);
+}
+
+FVector FClimbSolver::Solve(const FVector (&HandLocations)[MaxHands], float DeltaTime) const
+{
+	if (!ActiveMask)
+	{
+		return FVector::ZeroVector;
+	}
+
+	FVector Offset = FVector::ZeroVector;
+	for (int32 HandIndex = 0; HandIndex < MaxHands; HandIndex++)
+	{
+		if (IsGrabbing(HandIndex))
+		{
+			Offset += Anchors[HandIndex] - HandLocations[HandIndex];
+		}
+	}
+	Offset /= GetNumGrabbing();
+
+	if (SmoothingSpeed > 0.f)
+	{
+		// Frame rate independent exponential catch up
+		Offset *= 1.f - FMath::Exp(-SmoothingSpeed * DeltaTime);
+	}
+	return Offset;
+}
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Turns the hands' grab points into one body offset per frame. Each gripping hand keeps the world location it
+ * grabbed, and the body is moved by the average of how far the hands have drifted from their grab points, so
+ * both hands can hold on at once and the pawn is moved once however many hands are climbing. Grab points stay
+ * fixed while held, so any offset held back by smoothing or blocked by collision is caught up on later frames.
+ */
+class FClimbSolver
+{
+public:
+	enum { MaxHands = 2 };
+
+	void Grab(int32 HandIndex, const FVector& HandLocation);
+	void Release(int32 HandIndex);
+	void ReleaseAll() { ActiveMask = 0; }
+
+	bool IsClimbing() const { return ActiveMask != 0; }
+	bool IsGrabbing(int32 HandIndex) const { return (ActiveMask & (1 << HandIndex)) != 0; }
+	int32 GetNumGrabbing() const { return FMath::CountBits(ActiveMask); }
+
+	// Offset to move the body by so the hands at HandLocations head back to their grab points
+	FVector Solve(const FVector (&HandLocations)[MaxHands], float DeltaTime) const;
+
+public: // tuning
+	// How quickly (1/s) the body catches up with the hands. Zero applies the whole offset every frame.
+	float SmoothingSpeed = 0.f;
+
+private:
+	FVector Anchors[MaxHands];
+	uint32 ActiveMask = 0;
+};
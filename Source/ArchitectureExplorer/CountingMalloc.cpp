@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CountingMalloc.h"
+
+FCountingMalloc* FCountingMalloc::Install()
+{
+	FCountingMalloc* CountingMalloc = new FCountingMalloc(GMalloc);
+	GMalloc = CountingMalloc;
+	return CountingMalloc;
+}
+
+void FCountingMalloc::Uninstall()
+{
+	check(GMalloc == this);
+	GMalloc = Inner;
+}
+
+void* FCountingMalloc::Malloc(SIZE_T Count, uint32 Alignment)
+{
+	CountAllocation();
+	return Inner->Malloc(Count, Alignment);
+}
+
+void* FCountingMalloc::Realloc(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	if (Count > 0)
+	{
+		CountAllocation();
+	}
+	return Inner->Realloc(Original, Count, Alignment);
+}
+
+void FCountingMalloc::CountAllocation()
+{
+	if (IsInGameThread())
+	{
+		GameThreadAllocations++;
+	}
+}
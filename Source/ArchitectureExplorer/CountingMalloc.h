@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/MemoryBase.h"
+
+/**
+ * Counts game thread allocations while installed as GMalloc, and forwards everything to the allocator it replaced.
+ * Used by the benchmark and the automation tests to check that steady state locomotion doesn't allocate. It is
+ * never deleted, since other threads may still be inside it after it has been uninstalled.
+ */
+class FCountingMalloc final : public FMalloc
+{
+public:
+	// Wraps the current GMalloc and takes its place
+	static FCountingMalloc* Install();
+
+	// Puts the wrapped allocator back
+	void Uninstall();
+
+	uint64 GetGameThreadAllocations() const { return GameThreadAllocations; }
+
+	virtual void* Malloc(SIZE_T Count, uint32 Alignment) override;
+	virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override;
+	virtual void Free(void* Original) override { Inner->Free(Original); }
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+	virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+	virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+	virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+	virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+	virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+private:
+	explicit FCountingMalloc(FMalloc* InInner)
+		: Inner(InInner)
+	{
+	}
+
+	void CountAllocation();
+
+	FMalloc* Inner;
+	uint64 GameThreadAllocations = 0;
+};
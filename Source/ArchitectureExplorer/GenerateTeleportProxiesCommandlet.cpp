@@ -0,0 +1,368 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "GenerateTeleportProxiesCommandlet.h"
+
+#include "ArchitectureExplorer.h"
+#include "Components/BoxComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerStart.h"
+#include "Misc/PackageName.h"
+#include "Misc/Parse.h"
+#include "NavMesh/NavMeshBoundsVolume.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "StaticMeshResources.h"
+#include "UObject/Package.h"
+
+#if WITH_EDITOR
+namespace
+{
+	const FName StairsTag(TEXT("Stairs"));
+	const FName TeleportProxyProfile(TEXT("TeleportProxy"));
+
+	// Thickness (cm) of the box a ramp is made of
+	const float RampThickness = 10.f;
+
+	// Smallest half thickness (cm) of a box fitted around flat triangles
+	const float MinBoxHalfThickness = 2.5f;
+
+	struct FProxyCounts
+	{
+		int32 Clutter = 0;
+		int32 SimpleCollision = 0;
+		int32 Boxes = 0;
+		int32 Ramps = 0;
+		int32 Hollow = 0;
+	};
+
+	// Mesh section, axis the triangles face along and cell their centres fall in
+	typedef TTuple<int32, int32, FIntVector> FSurfaceKey;
+
+	// Splits LOD 0 into groups of triangles that share a section, face mostly along the same axis and have their
+	// centre in the same CellSize cell, and returns each group's bounds in the mesh's scaled local space. Floors,
+	// walls and ceilings each become thin slabs, so a room or an L shaped slab doesn't turn into one solid block.
+	void GetSurfaceBoxes(const UStaticMesh* Mesh, const FVector& Scale, float CellSize, TArray<FBox>& OutBoxes)
+	{
+		OutBoxes.Reset();
+		if (!Mesh->RenderData || Mesh->RenderData->LODResources.Num() == 0)
+		{
+			return;
+		}
+
+		const FStaticMeshLODResources& LOD = Mesh->RenderData->LODResources[0];
+		const FPositionVertexBuffer& Positions = LOD.VertexBuffers.PositionVertexBuffer;
+		const FIndexArrayView Indices = LOD.IndexBuffer.GetArrayView();
+		TMap<FSurfaceKey, FBox> Surfaces;
+		for (int32 SectionIndex = 0; SectionIndex < LOD.Sections.Num(); SectionIndex++)
+		{
+			const FStaticMeshSection& Section = LOD.Sections[SectionIndex];
+			for (uint32 Triangle = 0; Triangle < Section.NumTriangles; Triangle++)
+			{
+				const uint32 First = Section.FirstIndex + Triangle * 3;
+				const FVector A = Positions.VertexPosition(Indices[First]) * Scale;
+				const FVector B = Positions.VertexPosition(Indices[First + 1]) * Scale;
+				const FVector C = Positions.VertexPosition(Indices[First + 2]) * Scale;
+				const FVector Normal = FVector::CrossProduct(B - A, C - A);
+				if (Normal.IsNearlyZero())
+				{
+					continue;
+				}
+
+				const FVector AbsNormal = Normal.GetAbs();
+				const int32 Axis = AbsNormal.X >= AbsNormal.Y && AbsNormal.X >= AbsNormal.Z ? 0 : (AbsNormal.Y >= AbsNormal.Z ? 1 : 2);
+				const FVector Centre = (A + B + C) / 3.f;
+				const FIntVector Cell(FMath::FloorToInt(Centre.X / CellSize), FMath::FloorToInt(Centre.Y / CellSize), FMath::FloorToInt(Centre.Z / CellSize));
+				FBox& Box = Surfaces.FindOrAdd(FSurfaceKey(SectionIndex, Axis, Cell), FBox(ForceInit));
+				Box += A;
+				Box += B;
+				Box += C;
+			}
+		}
+		Surfaces.GenerateValueArray(OutBoxes);
+	}
+
+	// An oriented box that a player start or the middle of a nav mesh volume sits in would trap the player
+	bool EnclosesPlayerSpace(const FTransform& BoxTransform, const FVector& Extent, const TArray<FVector>& PlayerSpace)
+	{
+		for (const FVector& Location : PlayerSpace)
+		{
+			const FVector Local = BoxTransform.InverseTransformPosition(Location).GetAbs();
+			if (Local.X < Extent.X && Local.Y < Extent.Y && Local.Z < Extent.Z)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool IsStairs(const UStaticMeshComponent* Component)
+	{
+		return Component->ComponentHasTag(StairsTag)
+			|| (Component->GetOwner() && Component->GetOwner()->ActorHasTag(StairsTag))
+			|| Component->GetStaticMesh()->GetName().Contains(TEXT("Stair"));
+	}
+
+	bool HasSimpleCollision(const UStaticMesh* Mesh)
+	{
+		const UBodySetup* BodySetup = Mesh->BodySetup;
+		return BodySetup && BodySetup->AggGeom.GetElementCount() > 0 && BodySetup->CollisionTraceFlag != CTF_UseComplexAsSimple;
+	}
+
+	// Height of the mesh's surface above Location, or of its bounds' top if the trace misses
+	float GetSurfaceHeight(UStaticMeshComponent* Component, const FVector& Location, const FVector& Up, float HalfHeight)
+	{
+		FHitResult Hit;
+		const FVector Start = Location + Up * HalfHeight;
+		const FVector End = Location - Up * HalfHeight;
+		if (Component->LineTraceComponent(OUT Hit, Start, End, FCollisionQueryParams(NAME_None, true)))
+		{
+			return FVector::DotProduct(Hit.Location - Location, Up);
+		}
+		return HalfHeight;
+	}
+
+	UBoxComponent* AddBox(AActor* ProxyActor, const FVector& Center, const FQuat& Rotation, const FVector& Extent)
+	{
+		UBoxComponent* Box = NewObject<UBoxComponent>(ProxyActor, NAME_None, RF_Transactional);
+		Box->SetupAttachment(ProxyActor->GetRootComponent());
+		Box->SetMobility(EComponentMobility::Static);
+		Box->SetCollisionProfileName(TeleportProxyProfile);
+		Box->SetGenerateOverlapEvents(false);
+		Box->CanCharacterStepUpOn = ECB_No;
+		Box->SetBoxExtent(Extent, false);
+		Box->SetWorldLocationAndRotation(Center, Rotation);
+		ProxyActor->AddInstanceComponent(Box);
+		Box->RegisterComponent();
+		return Box;
+	}
+
+	// Thin boxes around the mesh's surfaces, or a ramp along the longer horizontal side for stairs
+	void AddProxy(AActor* ProxyActor, UStaticMeshComponent* Component, const FTransform& Transform, bool bStairs, float CellSize,
+		const TArray<FVector>& PlayerSpace, TArray<FBox>& SurfaceBoxes, FProxyCounts& Counts)
+	{
+		const FVector Scale = Transform.GetScale3D();
+		const FQuat Rotation = Transform.GetRotation();
+
+		if (!bStairs)
+		{
+			// Boxes are fitted in scaled mesh space, so they keep their orientation but not the scale
+			const FTransform Unscaled(Rotation, Transform.GetLocation());
+			GetSurfaceBoxes(Component->GetStaticMesh(), Scale, CellSize, OUT SurfaceBoxes);
+			for (const FBox& SurfaceBox : SurfaceBoxes)
+			{
+				const FVector Extent = SurfaceBox.GetExtent().ComponentMax(FVector(MinBoxHalfThickness));
+				const FTransform BoxTransform(Rotation, Unscaled.TransformPosition(SurfaceBox.GetCenter()));
+				if (EnclosesPlayerSpace(BoxTransform, Extent, PlayerSpace))
+				{
+					UE_LOG(LogVRLocomotion, Warning, TEXT("%s encloses a player start or nav mesh volume, left without a proxy there"), *Component->GetOwner()->GetName());
+					Counts.Hollow++;
+					continue;
+				}
+				AddBox(ProxyActor, BoxTransform.GetLocation(), Rotation, Extent);
+				Counts.Boxes++;
+			}
+			return;
+		}
+
+		const FBox LocalBox = Component->GetStaticMesh()->GetBoundingBox();
+		const FVector Extent = LocalBox.GetExtent() * Scale.GetAbs();
+		const FVector Center = Transform.TransformPosition(LocalBox.GetCenter());
+
+		const bool bRunAlongX = Extent.X >= Extent.Y;
+		const FVector Up = Rotation.GetAxisZ();
+		FVector Run = bRunAlongX ? Rotation.GetAxisX() : Rotation.GetAxisY();
+		const float HalfRun = bRunAlongX ? Extent.X : Extent.Y;
+		const float HalfWidth = bRunAlongX ? Extent.Y : Extent.X;
+
+		// Climb towards whichever end is higher
+		const float HeightForward = GetSurfaceHeight(Component, Center + Run * HalfRun * 0.8f, Up, Extent.Z);
+		const float HeightBack = GetSurfaceHeight(Component, Center - Run * HalfRun * 0.8f, Up, Extent.Z);
+		if (HeightBack > HeightForward)
+		{
+			Run = -Run;
+		}
+
+		// Top face on the diagonal from the bottom of the low end to the top of the high end
+		const FVector Slope = (Run * HalfRun + Up * Extent.Z).GetSafeNormal();
+		const FVector Normal = FVector::CrossProduct(FVector::CrossProduct(Slope, Up), Slope).GetSafeNormal();
+		const FQuat RampRotation = FRotationMatrix::MakeFromXZ(Slope, FVector::DotProduct(Normal, Up) < 0.f ? -Normal : Normal).ToQuat();
+		const FVector RampExtent(FVector(HalfRun, 0.f, Extent.Z).Size(), HalfWidth, RampThickness * 0.5f);
+		AddBox(ProxyActor, Center - RampRotation.GetAxisZ() * RampThickness * 0.5f, RampRotation, RampExtent);
+		Counts.Ramps++;
+	}
+}
+#endif
+
+UGenerateTeleportProxiesCommandlet::UGenerateTeleportProxiesCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UGenerateTeleportProxiesCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Usage: -run=GenerateTeleportProxies -Map=/Game/MainMap [-MinSize=100] [-CellSize=200]"));
+		return 1;
+	}
+	float MinSize = 100.f;
+	float CellSize = 200.f;
+	FParse::Value(*Params, TEXT("MinSize="), MinSize);
+	FParse::Value(*Params, TEXT("CellSize="), CellSize);
+	if (CellSize <= 0.f)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("CellSize must be positive"));
+		return 1;
+	}
+
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (!World)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.InitializeScenes(false)
+			.AllowAudioPlayback(false)
+			.RequiresHitProxies(false)
+			.CreatePhysicsScene(true)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(true)
+			.SetTransactional(false)
+			.CreateFXSystem(false));
+	}
+	World->UpdateWorldComponents(true, false);
+
+	// Replace the proxies of an earlier run
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (It->ActorHasTag(TeleportProxyTag))
+		{
+			World->DestroyActor(*It);
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transactional;
+	AActor* ProxyActor = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+	ProxyActor->SetActorLabel(TEXT("TeleportProxies"));
+	ProxyActor->Tags.Add(TeleportProxyTag);
+	USceneComponent* ProxyRoot = NewObject<USceneComponent>(ProxyActor, TEXT("Root"), RF_Transactional);
+	ProxyRoot->SetMobility(EComponentMobility::Static);
+	ProxyActor->SetRootComponent(ProxyRoot);
+	ProxyActor->AddInstanceComponent(ProxyRoot);
+	ProxyRoot->RegisterComponent();
+
+	// Where the player can be, which no proxy may enclose
+	TArray<FVector> PlayerSpace;
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		PlayerSpace.Add(It->GetActorLocation());
+	}
+	for (TActorIterator<ANavMeshBoundsVolume> It(World); It; ++It)
+	{
+		PlayerSpace.Add(It->GetComponentsBoundingBox(true).GetCenter());
+	}
+
+	FProxyCounts Counts;
+	TArray<FTransform> Transforms;
+	TArray<FBox> SurfaceBoxes;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (*It == ProxyActor)
+		{
+			continue;
+		}
+
+		TInlineComponentArray<UStaticMeshComponent*> Components(*It);
+		for (UStaticMeshComponent* Component : Components)
+		{
+			// Only static geometry that teleport arcs hit today
+			if (!Component->GetStaticMesh() || Component->Mobility != EComponentMobility::Static
+				|| !Component->IsQueryCollisionEnabled() || Component->GetCollisionResponseToChannel(ECC_Visibility) != ECR_Block)
+			{
+				continue;
+			}
+
+			Transforms.Reset();
+			if (const UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Component))
+			{
+				for (int32 Index = 0; Index < Instanced->GetInstanceCount(); Index++)
+				{
+					Instanced->GetInstanceTransform(Index, OUT Transforms.AddDefaulted_GetRef(), true);
+				}
+			}
+			else
+			{
+				Transforms.Add(Component->GetComponentTransform());
+			}
+
+			const FVector LocalSize = Component->GetStaticMesh()->GetBoundingBox().GetSize();
+			if (HasSimpleCollision(Component->GetStaticMesh()))
+			{
+				// Its own boxes and hulls are already simple, clutter included, which traces pass through
+				bool bAnyLarge = false;
+				for (const FTransform& Transform : Transforms)
+				{
+					bAnyLarge |= (LocalSize * Transform.GetScale3D().GetAbs()).GetMax() >= MinSize;
+				}
+				if (bAnyLarge)
+				{
+					Component->Modify();
+					Component->SetCollisionResponseToChannel(ECC_Teleport, ECR_Block);
+					Counts.SimpleCollision++;
+				}
+				else
+				{
+					Counts.Clutter++;
+				}
+				continue;
+			}
+
+			const bool bStairs = IsStairs(Component);
+			for (const FTransform& Transform : Transforms)
+			{
+				if ((LocalSize * Transform.GetScale3D().GetAbs()).GetMax() < MinSize)
+				{
+					Counts.Clutter++;
+					continue;
+				}
+				AddProxy(ProxyActor, Component, Transform, bStairs, CellSize, PlayerSpace, SurfaceBoxes, Counts);
+			}
+		}
+	}
+
+	World->MarkPackageDirty();
+	const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetMapPackageExtension());
+	const bool bSaved = UPackage::SavePackage(Package, World, RF_NoFlags, *Filename);
+	World->RemoveFromRoot();
+	if (!bSaved)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not save %s"), *Filename);
+		return 1;
+	}
+
+	UE_LOG(LogVRLocomotion, Display, TEXT("Saved %s: %d proxy boxes, %d ramps, %d meshes block with their own simple collision, %d clutter meshes skipped, %d boxes skipped around player space"),
+		*Filename, Counts.Boxes, Counts.Ramps, Counts.SimpleCollision, Counts.Clutter, Counts.Hollow);
+	return 0;
+#else
+	UE_LOG(LogVRLocomotion, Error, TEXT("GenerateTeleportProxies needs an editor build"));
+	return 1;
+#endif
+}
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "CoreMinimal.h"
+
+#include "GenerateTeleportProxiesCommandlet.generated.h"
+
+/**
+ * Builds the simple collision teleport arcs trace against on the Teleport channel, and saves it into the level.
+ * Static meshes smaller than MinSize are clutter and get nothing, so arcs fly through them. Larger ones with
+ * their own simple collision (boxes, convex hulls) block the Teleport channel with it. The rest, usually
+ * imported architecture that only has per-triangle collision, get thin oriented boxes around their floors, walls
+ * and ceilings: triangles are grouped by section, by the axis they face and by the CellSize cell they are in.
+ * A box that would enclose a player start or the middle of a nav mesh volume is left out with a warning.
+ * Meshes tagged Stairs (or named so) get a ramp from the bottom of the first step to the top of the last one.
+ * The boxes are components of one actor tagged TeleportProxy, which is replaced each time the commandlet runs.
+ *
+ * Usage: UE4Editor-Cmd ArchitectureExplorer.uproject -run=GenerateTeleportProxies -Map=/Game/MainMap [-MinSize=100] [-CellSize=200]
+ */
+UCLASS()
+class ARCHITECTUREEXPLORER_API UGenerateTeleportProxiesCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UGenerateTeleportProxiesCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
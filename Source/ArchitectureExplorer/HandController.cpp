@@ -2,18 +2,19 @@
 
 #include "HandController.h"
 
-#include "GameFramework/Character.h"
-#include "GameFramework/CharacterMovementComponent.h"
-#include "GameFramework/Pawn.h"
-#include "GameFramework/PlayerController.h"
+#include "ArchitectureExplorer.h"
+#include "VRCharacter.h"
 
-#define OUT
+namespace
+{
+	const FName ClimbableTag(TEXT("Climbable"));
+}
 
 // Sets default values
 AHandController::AHandController()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Climbing is updated from AVRCharacter::Tick, so the hand itself never needs to tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	MotionController = CreateDefaultSubobject<UMotionControllerComponent>(TEXT("MotionController"));
 	SetRootComponent(MotionController);
@@ -28,57 +29,48 @@ void AHandController::BeginPlay()
 	OnActorEndOverlap.AddDynamic(this, &AHandController::ActorEndOverlap);
 }
 
-// Called every frame
-void AHandController::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-	UpdateClimb();
-}
-
-void AHandController::PairController(AHandController* Controller)
-{
-	OtherController = Controller;
-	OtherController->OtherController = this;
-}
-
 void AHandController::ActorBeginOverlap(AActor* OverlappedActor, AActor* OtherActor)
 {
-	// UE_LOG(LogTemp, Display, TEXT("Begin OverlappedActor: %s"), *OverlappedActor->GetName());
+	// UE_LOG(LogVRLocomotion, Verbose, TEXT("Begin OverlappedActor: %s"), *OverlappedActor->GetName());
+
+	if (!IsClimbable(OtherActor))
+	{
+		return;
+	}
+	ClimbableOverlaps.Add(OtherActor);
 
 	if (!bCanClimb && CanClimb())
 	{
 		bCanClimb = true;
-		UE_LOG(LogTemp, Warning, TEXT("Can Climb"));
+		UE_LOG(LogVRLocomotion, Verbose, TEXT("%s can climb"), *GetName());
 		PlayHandHoldRumble();
 	}
 }
 
 void AHandController::ActorEndOverlap(AActor* OverlappedActor, AActor* OtherActor)
 {
-	// UE_LOG(LogTemp, Display, TEXT("End OverlappedActor: %s"), *OverlappedActor->GetName());
+	// UE_LOG(LogVRLocomotion, Verbose, TEXT("End OverlappedActor: %s"), *OverlappedActor->GetName());
+
+	if (ClimbableOverlaps.RemoveSingleSwap(OtherActor, false) == 0)
+	{
+		return;
+	}
 
 	if (bCanClimb && !CanClimb())
 	{
 		bCanClimb = false;
-		UE_LOG(LogTemp, Warning, TEXT("Cannot Climb"));
+		UE_LOG(LogVRLocomotion, Verbose, TEXT("%s cannot climb"), *GetName());
 	}
 }
-bool AHandController::CanClimb() const
-{
-	TArray<AActor*> OverlappingActors;
-	GetOverlappingActors(OUT OverlappingActors);
-	for (auto Actor : OverlappingActors)
-	{
-		if (Actor->ActorHasTag(TEXT("Climbable")))
-		{
-			// UE_LOG(LogTemp, Warning, TEXT("Climbable actor found: %s"), *Actor->GetName());
 
-			return true;
-		}
-	}
-	// UE_LOG(LogTemp, Warning, TEXT("No climbable actors found"));
+bool AHandController::IsClimbable(const AActor* Actor)
+{
+	return Actor && Actor->ActorHasTag(ClimbableTag);
+}
 
-	return false;
+void AHandController::SetOwningCharacter(AVRCharacter* InOwningCharacter)
+{
+	OwningCharacter = InOwningCharacter;
 }
 
 void AHandController::PlayHandHoldRumble()
@@ -88,83 +80,35 @@ void AHandController::PlayHandHoldRumble()
 		return;
 	}
 
-	EControllerHand Hand = MotionController->GetTrackingSource();
-
-	APlayerController* PlayerController = nullptr;
-
-	if (GetCharacterPlayerController(OUT PlayerController))
-	{
-		FString HandString = UEnum::GetValueAsString(Hand);
-
-		UE_LOG(LogTemp, Warning, TEXT("Player controller name: %s"), *PlayerController->GetName());
-
-		PlayerController->PlayHapticEffect(HandHoldRumble, Hand); // If not working, try restarting SteamVR or replacing batteries.
-	}
-}
-
-bool AHandController::GetCharacterPlayerController(APlayerController*& OutPlayerController)
-{
-	auto Pawn = Cast<APawn>(GetAttachParentActor());
-
-	if (!Pawn)
-	{
-		return false;
-	}
-
-	APlayerController* PlayerController = Cast<APlayerController>(Pawn->GetController());
-
-	if (!PlayerController)
+	if (AVRCharacter* Character = OwningCharacter.Get())
 	{
-		return false;
+		Character->GetHapticsDispatcher().Request(MotionController->GetTrackingSource(), HandHoldRumble);
 	}
-
-	OutPlayerController = PlayerController;
-	UE_LOG(LogTemp, Warning, TEXT("Player controller name: %s"), *PlayerController->GetName());
-	// UE_LOG(LogTemp, Warning, TEXT("Out Player controller name: %s"), *OutPlayerController->GetName());
-
-	return true;
 }
 
-void AHandController::Grip()
+bool AHandController::Grip()
 {
-	// Only update StartLocation if the character is not currently climbing
+	// Grabbing again while already holding on keeps the original grab point
 	if (bCanClimb && !bIsClimbing)
 	{
 		bIsClimbing = true;
-		ClimbingStartLocation = GetActorLocation();
-		auto Character = Cast<ACharacter>(GetAttachParentActor());
-		if (Character)
-		{
-			Character->GetCharacterMovement()->SetMovementMode(EMovementMode::MOVE_Flying);
-		}
-		OtherController->Release();
+		return true;
 	}
+	return false;
 }
 
-void AHandController::Release()
+bool AHandController::Release()
 {
 	if (bIsClimbing)
 	{
 		bIsClimbing = false;
-		// If both controllers are not climbing, then make the character fall down
-		if (!OtherController->bIsClimbing)
-		{
-			auto Character = Cast<ACharacter>(GetAttachParentActor());
-			if (Character)
-			{
-				Character->GetCharacterMovement()->SetMovementMode(EMovementMode::MOVE_Falling);
-			}
-		}
+		return true;
 	}
+	return false;
 }
 
-void AHandController::UpdateClimb()
+void AHandController::SetTrackingEnabled(bool bEnabled)
 {
-	if (!bIsClimbing)
-	{
-		return;
-	}
-	FVector HandControllerDelta = GetActorLocation() - ClimbingStartLocation;
-
-	GetAttachParentActor()->AddActorWorldOffset(-HandControllerDelta);
+	MotionController->SetComponentTickEnabled(bEnabled);
+	MotionController->bDisableLowLatencyUpdate = !bEnabled;
 }
@@ -8,6 +8,8 @@
 
 #include "HandController.generated.h"
 
+class AVRCharacter;
+
 UCLASS()
 class ARCHITECTUREEXPLORER_API AHandController : public AActor
 {
@@ -22,12 +24,22 @@ protected:
 	virtual void BeginPlay() override;
 
 public:
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
 	void SetHand(EControllerHand Hand) { MotionController->SetTrackingSource(Hand); }
-	void PairController(AHandController* Controller);
-	void Grip();
-	void Release();
+	// True when the hand took hold of something climbable. AVRCharacter's climb solver moves the body.
+	bool Grip();
+	// True when the hand let go of a hold
+	bool Release();
+
+	bool IsClimbing() const { return bIsClimbing; }
+
+	// Remote players' hands follow replicated poses instead of this machine's controllers
+	void SetTrackingEnabled(bool bEnabled);
+	void SetRemoteClimbing(bool bClimbing) { bIsClimbing = bClimbing; }
+
+	UMotionControllerComponent* GetMotionController() const { return MotionController; }
+
+	// Rumble goes through the owning character's dispatcher, which knows its player controller
+	void SetOwningCharacter(AVRCharacter* InOwningCharacter);
 
 private:
 	// callbacks
@@ -38,13 +50,11 @@ private:
 	void ActorEndOverlap(AActor* OverlappedActor, AActor* OtherActor);
 
 	// helpers
-	bool CanClimb() const;
-
-	void PlayHandHoldRumble();
+	bool CanClimb() const { return ClimbableOverlaps.Num() > 0; }
 
-	bool GetCharacterPlayerController(APlayerController*& OutPlayerController);
+	static bool IsClimbable(const AActor* Actor);
 
-	void UpdateClimb();
+	void PlayHandHoldRumble();
 
 	// default subobject
 	UPROPERTY(VisibleAnywhere)
@@ -60,13 +70,13 @@ private:
 	UPROPERTY(VisibleAnywhere)
 	bool bCanClimb = false;
 
-	UPROPERTY(VisibleAnywhere)
-	bool bIsClimbing = false;
+	// Overlapping actors that were tagged Climbable when their overlap began, kept up to date by the
+	// overlap callbacks. Each actor's tag is only checked once, and ending an overlap removes exactly
+	// the actors that were counted even if their tags changed since.
+	TArray<const AActor*, TInlineAllocator<8>> ClimbableOverlaps;
 
 	UPROPERTY(VisibleAnywhere)
-	FVector ClimbingStartLocation;
+	bool bIsClimbing = false;
 
-	// Able to edit from the other class?
-	UPROPERTY(VisibleAnywhere)
-	AHandController* OtherController;
+	TWeakObjectPtr<AVRCharacter> OwningCharacter;
 };
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HapticsDispatcher.h"
+
+#include "ArchitectureExplorer.h"
+#include "GameFramework/PlayerController.h"
+#include "Haptics/HapticFeedbackEffect_Base.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Haptic Effects Requested"), STAT_HapticsRequested, STATGROUP_VRLocomotion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Haptic Effects Dispatched"), STAT_HapticsDispatched, STATGROUP_VRLocomotion);
+
+void FHapticsDispatcher::Request(EControllerHand Hand, UHapticFeedbackEffect_Base* Effect)
+{
+	if (!Effect || (Hand != EControllerHand::Left && Hand != EControllerHand::Right))
+	{
+		return;
+	}
+
+	++Requested;
+	INC_DWORD_STAT(STAT_HapticsRequested);
+	Hands[Hand == EControllerHand::Left ? 0 : 1].PendingEffect = Effect;
+	bAnyPending = true;
+}
+
+void FHapticsDispatcher::Flush(float WorldTime)
+{
+	if (!bAnyPending)
+	{
+		return;
+	}
+	bAnyPending = false;
+
+	APlayerController* Controller = PlayerController.Get();
+	for (int32 HandIndex = 0; HandIndex < 2; HandIndex++)
+	{
+		FHandQueue& Queue = Hands[HandIndex];
+		UHapticFeedbackEffect_Base* Effect = Queue.PendingEffect;
+		Queue.PendingEffect = nullptr;
+		if (!Effect || !Controller || WorldTime - Queue.LastPlayTime < MinIntervalSeconds)
+		{
+			continue;
+		}
+
+		// If not working, try restarting SteamVR or replacing batteries.
+		Controller->PlayHapticEffect(Effect, HandIndex == 0 ? EControllerHand::Left : EControllerHand::Right);
+		Queue.LastPlayTime = WorldTime;
+		++Dispatched;
+		INC_DWORD_STAT(STAT_HapticsDispatched);
+	}
+}
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InputCoreTypes.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class APlayerController;
+class UHapticFeedbackEffect_Base;
+
+/**
+ * Plays haptic effects on a player's motion controllers. Requests are queued per hand and flushed once a frame,
+ * so any number of requests for one hand in a frame plays a single effect, and a hand that played recently
+ * ignores new requests until MinIntervalSeconds has passed. The player controller is cached by the owning
+ * pawn on possession instead of being looked up per request.
+ */
+class FHapticsDispatcher
+{
+public:
+	void SetPlayerController(APlayerController* InPlayerController) { PlayerController = InPlayerController; }
+
+	// Queues Effect on Hand. The latest request of a frame wins.
+	void Request(EControllerHand Hand, UHapticFeedbackEffect_Base* Effect);
+
+	// Plays the queued effects that aren't rate limited. Call once per frame.
+	void Flush(float WorldTime);
+
+	uint32 GetRequested() const { return Requested; }
+	uint32 GetDispatched() const { return Dispatched; }
+
+public: // tuning
+	// Shortest time between two effects on the same hand
+	float MinIntervalSeconds = 0.1f;
+
+private:
+	struct FHandQueue
+	{
+		UHapticFeedbackEffect_Base* PendingEffect = nullptr;
+		float LastPlayTime = -BIG_NUMBER;
+	};
+
+	// Left and right
+	FHandQueue Hands[2];
+	bool bAnyPending = false;
+
+	TWeakObjectPtr<APlayerController> PlayerController;
+
+	uint32 Requested = 0;
+	uint32 Dispatched = 0;
+};
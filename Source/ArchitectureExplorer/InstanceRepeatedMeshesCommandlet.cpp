@@ -0,0 +1,403 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "InstanceRepeatedMeshesCommandlet.h"
+
+#include "ArchitectureExplorer.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Level.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Misc/PackageName.h"
+#include "Misc/Parse.h"
+#include "UObject/Package.h"
+
+#if WITH_EDITOR
+namespace
+{
+	const FName ClimbableTag(TEXT("Climbable"));
+
+	// Per component render settings an HISM applies to all of its instances alike
+	struct FInstanceRenderSettings
+	{
+		float LDMaxDrawDistance = 0.f;
+		float CachedMaxDrawDistance = 0.f;
+		float MinDrawDistance = 0.f;
+		FLightingChannels LightingChannels;
+		int32 CustomDepthStencilValue = 0;
+		ERendererStencilMask CustomDepthStencilWriteMask = ERendererStencilMask::ERSM_Default;
+		int32 TranslucencySortPriority = 0;
+		bool bRenderCustomDepth = false;
+		bool bRenderInMainPass = true;
+		bool bVisibleInReflectionCaptures = true;
+		bool bReceivesDecals = true;
+		bool bCastShadow = false;
+		bool bCastDynamicShadow = true;
+		bool bCastStaticShadow = true;
+		bool bCastHiddenShadow = false;
+		bool bCastShadowAsTwoSided = false;
+
+		static FInstanceRenderSettings Make(const UPrimitiveComponent* Component)
+		{
+			FInstanceRenderSettings Settings;
+			Settings.LDMaxDrawDistance = Component->LDMaxDrawDistance;
+			Settings.CachedMaxDrawDistance = Component->CachedMaxDrawDistance;
+			Settings.MinDrawDistance = Component->MinDrawDistance;
+			Settings.LightingChannels = Component->LightingChannels;
+			Settings.CustomDepthStencilValue = Component->CustomDepthStencilValue;
+			Settings.CustomDepthStencilWriteMask = Component->CustomDepthStencilWriteMask;
+			Settings.TranslucencySortPriority = Component->TranslucencySortPriority;
+			Settings.bRenderCustomDepth = Component->bRenderCustomDepth;
+			Settings.bRenderInMainPass = Component->bRenderInMainPass;
+			Settings.bVisibleInReflectionCaptures = Component->bVisibleInReflectionCaptures;
+			Settings.bReceivesDecals = Component->bReceivesDecals;
+			Settings.bCastShadow = Component->CastShadow;
+			Settings.bCastDynamicShadow = Component->bCastDynamicShadow;
+			Settings.bCastStaticShadow = Component->bCastStaticShadow;
+			Settings.bCastHiddenShadow = Component->bCastHiddenShadow;
+			Settings.bCastShadowAsTwoSided = Component->bCastShadowAsTwoSided;
+			return Settings;
+		}
+
+		void ApplyTo(UPrimitiveComponent* Component) const
+		{
+			Component->LDMaxDrawDistance = LDMaxDrawDistance;
+			Component->CachedMaxDrawDistance = CachedMaxDrawDistance;
+			Component->MinDrawDistance = MinDrawDistance;
+			Component->LightingChannels = LightingChannels;
+			Component->CustomDepthStencilValue = CustomDepthStencilValue;
+			Component->CustomDepthStencilWriteMask = CustomDepthStencilWriteMask;
+			Component->TranslucencySortPriority = TranslucencySortPriority;
+			Component->bRenderCustomDepth = bRenderCustomDepth;
+			Component->bRenderInMainPass = bRenderInMainPass;
+			Component->bVisibleInReflectionCaptures = bVisibleInReflectionCaptures;
+			Component->bReceivesDecals = bReceivesDecals;
+			Component->CastShadow = bCastShadow;
+			Component->bCastDynamicShadow = bCastDynamicShadow;
+			Component->bCastStaticShadow = bCastStaticShadow;
+			Component->bCastHiddenShadow = bCastHiddenShadow;
+			Component->bCastShadowAsTwoSided = bCastShadowAsTwoSided;
+		}
+
+		bool operator==(const FInstanceRenderSettings& Other) const
+		{
+			return LDMaxDrawDistance == Other.LDMaxDrawDistance && CachedMaxDrawDistance == Other.CachedMaxDrawDistance
+				&& MinDrawDistance == Other.MinDrawDistance
+				&& LightingChannels.bChannel0 == Other.LightingChannels.bChannel0
+				&& LightingChannels.bChannel1 == Other.LightingChannels.bChannel1
+				&& LightingChannels.bChannel2 == Other.LightingChannels.bChannel2
+				&& CustomDepthStencilValue == Other.CustomDepthStencilValue && CustomDepthStencilWriteMask == Other.CustomDepthStencilWriteMask
+				&& TranslucencySortPriority == Other.TranslucencySortPriority && bRenderCustomDepth == Other.bRenderCustomDepth
+				&& bRenderInMainPass == Other.bRenderInMainPass && bVisibleInReflectionCaptures == Other.bVisibleInReflectionCaptures
+				&& bReceivesDecals == Other.bReceivesDecals && bCastShadow == Other.bCastShadow
+				&& bCastDynamicShadow == Other.bCastDynamicShadow && bCastStaticShadow == Other.bCastStaticShadow
+				&& bCastHiddenShadow == Other.bCastHiddenShadow && bCastShadowAsTwoSided == Other.bCastShadowAsTwoSided;
+		}
+	};
+
+	// Everything two actors must share to become instances of one component
+	struct FInstanceGroupKey
+	{
+		// Instances stay in the level their actors were in
+		ULevel* Level = nullptr;
+		UStaticMesh* Mesh = nullptr;
+		TArray<UMaterialInterface*, TInlineAllocator<4>> Materials;
+		FName CollisionProfile;
+		ECollisionEnabled::Type CollisionEnabled = ECollisionEnabled::NoCollision;
+		FCollisionResponseContainer CollisionResponses;
+		bool bGenerateOverlapEvents = false;
+		FInstanceRenderSettings RenderSettings;
+		bool bClimbable = false;
+		FIntVector Cell;
+
+		bool operator==(const FInstanceGroupKey& Other) const
+		{
+			return Level == Other.Level && Mesh == Other.Mesh && Materials == Other.Materials && CollisionProfile == Other.CollisionProfile
+				&& CollisionEnabled == Other.CollisionEnabled && CollisionResponses == Other.CollisionResponses
+				&& bGenerateOverlapEvents == Other.bGenerateOverlapEvents && RenderSettings == Other.RenderSettings
+				&& bClimbable == Other.bClimbable && Cell == Other.Cell;
+		}
+
+		friend uint32 GetTypeHash(const FInstanceGroupKey& Key)
+		{
+			uint32 Hash = HashCombine(GetTypeHash(Key.Mesh), GetTypeHash(Key.Cell));
+			Hash = HashCombine(Hash, GetTypeHash(Key.Level));
+			for (const UMaterialInterface* Material : Key.Materials)
+			{
+				Hash = HashCombine(Hash, GetTypeHash(Material));
+			}
+			return HashCombine(Hash, GetTypeHash(Key.CollisionProfile) ^ (Key.bClimbable ? 1u : 0u));
+		}
+	};
+
+	struct FLevelCounts
+	{
+		int32 Actors = 0;
+		int32 Components = 0;
+		// Mesh sections at LOD 0, drawn once per component (instanced or not)
+		int32 Draws = 0;
+	};
+
+	FLevelCounts CountLevel(UWorld* World)
+	{
+		FLevelCounts Counts;
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			Counts.Actors++;
+			TInlineComponentArray<UPrimitiveComponent*> Components(*It);
+			for (const UPrimitiveComponent* Component : Components)
+			{
+				Counts.Components++;
+				const UStaticMeshComponent* MeshComponent = Cast<UStaticMeshComponent>(Component);
+				const UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Component);
+				if (MeshComponent && MeshComponent->GetStaticMesh() && MeshComponent->IsVisible() && (!Instanced || Instanced->GetInstanceCount() > 0))
+				{
+					Counts.Draws += MeshComponent->GetStaticMesh()->GetNumSections(0);
+				}
+			}
+		}
+		return Counts;
+	}
+
+	// Settings an instance can't have on its own, so a component using them would lose them when merged
+	bool HasPerComponentOverrides(const UStaticMeshComponent* Component)
+	{
+		if (Component->bOverrideLightMapRes || Component->ForcedLodModel > 0)
+		{
+			return true;
+		}
+		for (const FStaticMeshComponentLODInfo& LODInfo : Component->LODData)
+		{
+			if (LODInfo.OverrideVertexColors || LODInfo.PaintedVertices.Num() > 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Plain, visible static mesh actors only, whose one component can be replaced by an instance without losing anything
+	bool CanInstance(const AStaticMeshActor* Actor)
+	{
+		if (Actor->GetClass() != AStaticMeshActor::StaticClass() || Actor->GetAttachParentActor() || Actor->IsHidden())
+		{
+			return false;
+		}
+		for (const FName& Tag : Actor->Tags)
+		{
+			if (Tag != ClimbableTag)
+			{
+				return false;
+			}
+		}
+		TArray<AActor*> AttachedActors;
+		Actor->GetAttachedActors(OUT AttachedActors);
+		const UStaticMeshComponent* Component = Actor->GetStaticMeshComponent();
+		return AttachedActors.Num() == 0 && Component && Component->GetStaticMesh() && Component->Mobility == EComponentMobility::Static
+			&& Component->ComponentTags.Num() == 0 && Actor->GetComponents().Num() == 1
+			&& Component->IsVisible() && !Component->bHiddenInGame && !HasPerComponentOverrides(Component);
+	}
+
+	FInstanceGroupKey MakeKey(const AStaticMeshActor* Actor, float CellSize)
+	{
+		const UStaticMeshComponent* Component = Actor->GetStaticMeshComponent();
+		FInstanceGroupKey Key;
+		Key.Level = Actor->GetLevel();
+		Key.Mesh = Component->GetStaticMesh();
+		for (int32 Index = 0; Index < Component->GetNumMaterials(); Index++)
+		{
+			Key.Materials.Add(Component->GetMaterial(Index));
+		}
+		Key.CollisionProfile = Component->GetCollisionProfileName();
+		Key.CollisionEnabled = Component->GetCollisionEnabled();
+		Key.CollisionResponses = Component->GetCollisionResponseToChannels();
+		Key.bGenerateOverlapEvents = Component->GetGenerateOverlapEvents();
+		Key.RenderSettings = FInstanceRenderSettings::Make(Component);
+		Key.bClimbable = Actor->ActorHasTag(ClimbableTag);
+		const FVector Location = Actor->GetActorLocation();
+		Key.Cell = FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+		return Key;
+	}
+
+	void MergeGroup(UWorld* World, const FInstanceGroupKey& Key, const TArray<AStaticMeshActor*>& Actors)
+	{
+		const UStaticMeshComponent* Source = Actors[0]->GetStaticMeshComponent();
+
+		// Instances are placed relative to the group's first actor, which keeps the cell's bounds tight
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transactional;
+		SpawnParams.OverrideLevel = Key.Level;
+		const FTransform ActorTransform(Actors[0]->GetActorLocation());
+		AActor* MergedActor = World->SpawnActor<AActor>(AActor::StaticClass(), ActorTransform, SpawnParams);
+		MergedActor->SetActorLabel(FString::Printf(TEXT("%s_Instances_%d_%d_%d"), *Key.Mesh->GetName(), Key.Cell.X, Key.Cell.Y, Key.Cell.Z));
+		if (Key.bClimbable)
+		{
+			// AHandController checks the tag on the overlapped actor
+			MergedActor->Tags.Add(ClimbableTag);
+		}
+
+		UHierarchicalInstancedStaticMeshComponent* Instances = NewObject<UHierarchicalInstancedStaticMeshComponent>(MergedActor, TEXT("Instances"), RF_Transactional);
+		Instances->SetMobility(EComponentMobility::Static);
+		Instances->SetStaticMesh(Key.Mesh);
+		for (int32 Index = 0; Index < Key.Materials.Num(); Index++)
+		{
+			Instances->SetMaterial(Index, Key.Materials[Index]);
+		}
+		Instances->BodyInstance.CopyBodyInstancePropertiesFrom(&Source->BodyInstance);
+		Instances->SetGenerateOverlapEvents(Key.bGenerateOverlapEvents);
+		Key.RenderSettings.ApplyTo(Instances);
+		Instances->CanCharacterStepUpOn = Source->CanCharacterStepUpOn;
+		MergedActor->SetRootComponent(Instances);
+		MergedActor->AddInstanceComponent(Instances);
+		Instances->SetWorldTransform(ActorTransform);
+		Instances->RegisterComponent();
+
+		for (AStaticMeshActor* Actor : Actors)
+		{
+			Instances->AddInstanceWorldSpace(Actor->GetActorTransform());
+			World->DestroyActor(Actor);
+		}
+	}
+}
+#endif
+
+UInstanceRepeatedMeshesCommandlet::UInstanceRepeatedMeshesCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UInstanceRepeatedMeshesCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Usage: -run=InstanceRepeatedMeshes -Map=/Game/MainMap [-CellSize=2000] [-MinInstances=4] [-DryRun]"));
+		return 1;
+	}
+	float CellSize = 2000.f;
+	int32 MinInstances = 4;
+	FParse::Value(*Params, TEXT("CellSize="), CellSize);
+	FParse::Value(*Params, TEXT("MinInstances="), MinInstances);
+	const bool bDryRun = FParse::Param(*Params, TEXT("DryRun"));
+	if (CellSize <= 0.f || MinInstances < 2)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("CellSize must be positive and MinInstances at least 2"));
+		return 1;
+	}
+
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (!World)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+
+	World->WorldType = EWorldType::Editor;
+	World->AddToRoot();
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.InitializeScenes(false)
+			.AllowAudioPlayback(false)
+			.RequiresHitProxies(false)
+			.CreatePhysicsScene(false)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(false)
+			.SetTransactional(false)
+			.CreateFXSystem(false));
+	}
+	World->UpdateWorldComponents(true, false);
+
+	// Streaming levels are merged and saved on their own, each keeping its instances
+	for (ULevelStreaming* StreamingLevel : World->GetStreamingLevels())
+	{
+		if (StreamingLevel)
+		{
+			StreamingLevel->SetShouldBeLoaded(true);
+			StreamingLevel->SetShouldBeVisible(true);
+		}
+	}
+	World->FlushLevelStreaming(EFlushLevelStreamingType::Full);
+
+	const FLevelCounts Before = CountLevel(World);
+
+	TMap<FInstanceGroupKey, TArray<AStaticMeshActor*>> Groups;
+	for (TActorIterator<AStaticMeshActor> It(World); It; ++It)
+	{
+		if (CanInstance(*It))
+		{
+			Groups.FindOrAdd(MakeKey(*It, CellSize)).Add(*It);
+		}
+	}
+
+	int32 MergedGroups = 0;
+	int32 MergedActors = 0;
+	int32 ClimbableGroups = 0;
+	TSet<ULevel*> MergedLevels;
+	for (const TPair<FInstanceGroupKey, TArray<AStaticMeshActor*>>& Group : Groups)
+	{
+		if (Group.Value.Num() < MinInstances)
+		{
+			continue;
+		}
+		MergedGroups++;
+		MergedActors += Group.Value.Num();
+		ClimbableGroups += Group.Key.bClimbable ? 1 : 0;
+		UE_LOG(LogVRLocomotion, Verbose, TEXT("%s in cell %s: %d actors%s"), *Group.Key.Mesh->GetName(), *Group.Key.Cell.ToString(),
+			Group.Value.Num(), Group.Key.bClimbable ? TEXT(", climbable") : TEXT(""));
+		MergedLevels.Add(Group.Key.Level);
+		if (!bDryRun)
+		{
+			MergeGroup(World, Group.Key, Group.Value);
+		}
+	}
+
+	UE_LOG(LogVRLocomotion, Display, TEXT("%s %d actors into %d instanced components (%d climbable) in %d levels"),
+		bDryRun ? TEXT("Would merge") : TEXT("Merged"), MergedActors, MergedGroups, ClimbableGroups, MergedLevels.Num());
+	UE_LOG(LogVRLocomotion, Display, TEXT("Before: %d actors, %d primitive components, %d draws"), Before.Actors, Before.Components, Before.Draws);
+	if (bDryRun && MergedGroups > 0)
+	{
+		UE_LOG(LogVRLocomotion, Display, TEXT("Merged groups would lose their built static lighting, the map would need a lighting rebuild"));
+	}
+	if (bDryRun || MergedGroups == 0)
+	{
+		World->RemoveFromRoot();
+		return 0;
+	}
+
+	const FLevelCounts After = CountLevel(World);
+	UE_LOG(LogVRLocomotion, Display, TEXT("After: %d actors, %d primitive components, %d draws"), After.Actors, After.Components, After.Draws);
+	UE_LOG(LogVRLocomotion, Warning, TEXT("The %d merged groups have no built static lighting, rebuild lighting for %s and its sublevels before shipping them"), MergedGroups, *MapName);
+
+	int32 Result = 0;
+	for (ULevel* Level : MergedLevels)
+	{
+		UPackage* LevelPackage = Level->GetOutermost();
+		UWorld* LevelWorld = UWorld::FindWorldInPackage(LevelPackage);
+		LevelPackage->MarkPackageDirty();
+		const FString Filename = FPackageName::LongPackageNameToFilename(LevelPackage->GetName(), FPackageName::GetMapPackageExtension());
+		if (!LevelWorld || !UPackage::SavePackage(LevelPackage, LevelWorld, RF_NoFlags, *Filename))
+		{
+			UE_LOG(LogVRLocomotion, Error, TEXT("Could not save %s"), *Filename);
+			Result = 1;
+			continue;
+		}
+		UE_LOG(LogVRLocomotion, Display, TEXT("Saved %s"), *Filename);
+	}
+	World->RemoveFromRoot();
+	return Result;
+#else
+	UE_LOG(LogVRLocomotion, Error, TEXT("InstanceRepeatedMeshes needs an editor build"));
+	return 1;
+#endif
+}
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "CoreMinimal.h"
+
+#include "InstanceRepeatedMeshesCommandlet.generated.h"
+
+/**
+ * Replaces repeated static mesh actors in a map and its streaming sublevels with hierarchical instanced static mesh
+ * components, and saves every level it changed. Plain static mesh actors are grouped by level, mesh, materials,
+ * collision, render settings (draw distances, lighting channels, custom depth and stencil, shadow casting,
+ * reflection capture visibility, translucency sort priority) and Climbable tag within cubic cells of CellSize; every
+ * group of at least MinInstances becomes one actor in the same level with one HISM component, which keeps the
+ * group's collision and render settings and, for climbable groups, the Climbable tag, so hands can still climb them.
+ * Actors with other tags, attachments, non-static mobility or hidden components are left alone, and so are
+ * components with painted vertex colors, a lightmap resolution override or a forced LOD, which instances can't
+ * keep. Merged groups lose their built static lighting, so the level needs a lighting rebuild afterwards.
+ * Prints actor, component and estimated draw counts before and after; -DryRun only prints them.
+ *
+ * Usage: UE4Editor-Cmd ArchitectureExplorer.uproject -run=InstanceRepeatedMeshes -Map=/Game/MainMap [-CellSize=2000] [-MinInstances=4] [-DryRun]
+ */
+UCLASS()
+class ARCHITECTUREEXPLORER_API UInstanceRepeatedMeshesCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UInstanceRepeatedMeshesCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LocomotionResolution.h"
+
+float FLocomotionResolution::GetTargetScale(ELocomotionActivity Activity) const
+{
+	float Target = 1.f;
+	if (EnumHasAnyFlags(Activity, ELocomotionActivity::Aiming))
+	{
+		Target = FMath::Min(Target, AimingScale);
+	}
+	if (EnumHasAnyFlags(Activity, ELocomotionActivity::Teleporting))
+	{
+		Target = FMath::Min(Target, TeleportingScale);
+	}
+	if (EnumHasAnyFlags(Activity, ELocomotionActivity::Moving))
+	{
+		Target = FMath::Min(Target, MovingScale);
+	}
+	if (EnumHasAnyFlags(Activity, ELocomotionActivity::Climbing))
+	{
+		Target = FMath::Min(Target, ClimbingScale);
+	}
+	return Target;
+}
+
+bool FLocomotionResolution::Update(ELocomotionActivity Activity, float DeltaTime)
+{
+	const float Target = GetTargetScale(Activity);
+	if (Target <= Scale)
+	{
+		// Down right away, the expensive frames are happening now
+		const bool bChanged = Target != Scale;
+		Scale = Target;
+		SecondsSinceLowered = 0.f;
+		return bChanged;
+	}
+
+	SecondsSinceLowered += DeltaTime;
+	if (SecondsSinceLowered < RestoreDelay)
+	{
+		return false;
+	}
+	Scale = Target;
+	return true;
+}
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// What the player is doing this frame, any combination
+enum class ELocomotionActivity : uint8
+{
+	None = 0,
+	Aiming = 1 << 0,
+	Teleporting = 1 << 1,
+	Moving = 1 << 2,
+	Climbing = 1 << 3,
+};
+ENUM_CLASS_FLAGS(ELocomotionActivity);
+
+/**
+ * Picks the render resolution scale (vr.PixelDensity) from what the player is doing. Aiming, teleporting, smooth
+ * movement and climbing are when frames cost the most and when lower peripheral detail goes unnoticed, so each
+ * activity has a scale and the lowest active one wins. Lowering takes effect at once; going back up waits until the
+ * lower scale hasn't been asked for over RestoreDelay, then happens in a single step. Every change of
+ * vr.PixelDensity reallocates the eye render targets, so easing up over many small steps would cost a hitch each.
+ * Pure decision logic, the owner applies the result.
+ */
+class FLocomotionResolution
+{
+public:
+	// Feeds one frame. Returns true when the scale changed.
+	bool Update(ELocomotionActivity Activity, float DeltaTime);
+
+	// Scale to apply, relative to the user's own setting. Only moves when Update returns true.
+	float GetScale() const { return Scale; }
+
+	float GetTargetScale(ELocomotionActivity Activity) const;
+
+public: // tuning
+	float AimingScale = 0.9f;
+	float TeleportingScale = 0.7f;
+	float MovingScale = 0.8f;
+	float ClimbingScale = 0.85f;
+
+	// Seconds the target has to stay higher before the scale goes back up
+	float RestoreDelay = 0.5f;
+
+private:
+	float Scale = 1.f;
+	float SecondsSinceLowered = 0.f;
+};
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LocomotionResolution.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	const float FrameDeltaTime = 1.f / 90.f;
+
+	// Feeds Activity for Seconds, and returns how many frames reported a change
+	int32 Run(FLocomotionResolution& Resolution, ELocomotionActivity Activity, float Seconds)
+	{
+		int32 Changes = 0;
+		for (float Time = 0.f; Time < Seconds; Time += FrameDeltaTime)
+		{
+			Changes += Resolution.Update(Activity, FrameDeltaTime) ? 1 : 0;
+		}
+		return Changes;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLocomotionResolutionSequenceTest, "ArchitectureExplorer.VRLocomotion.LocomotionResolution.Sequence",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLocomotionResolutionSequenceTest::RunTest(const FString& Parameters)
+{
+	FLocomotionResolution Resolution;
+
+	TestEqual(TEXT("Resting changes nothing"), Run(Resolution, ELocomotionActivity::None, 1.f), 0);
+	TestEqual(TEXT("Resting scale"), Resolution.GetScale(), 1.f);
+
+	TestTrue(TEXT("Moving lowers the scale on its first frame"), Resolution.Update(ELocomotionActivity::Moving, FrameDeltaTime));
+	TestEqual(TEXT("Moving scale"), Resolution.GetScale(), Resolution.MovingScale);
+	TestEqual(TEXT("Moving on changes nothing"), Run(Resolution, ELocomotionActivity::Moving, 1.f), 0);
+
+	// The lowest active scale wins
+	TestTrue(TEXT("Teleporting lowers the scale further"), Resolution.Update(ELocomotionActivity::Moving | ELocomotionActivity::Teleporting, FrameDeltaTime));
+	TestEqual(TEXT("Teleporting scale"), Resolution.GetScale(), Resolution.TeleportingScale);
+
+	// Held until RestoreDelay has passed
+	TestEqual(TEXT("Nothing changes during the hold"), Run(Resolution, ELocomotionActivity::None, Resolution.RestoreDelay - 2.f * FrameDeltaTime), 0);
+	TestEqual(TEXT("Scale during the hold"), Resolution.GetScale(), Resolution.TeleportingScale);
+
+	// Then goes back up in a single step, since every change reallocates the render targets
+	TestEqual(TEXT("Restores in one change"), Run(Resolution, ELocomotionActivity::None, 2.f), 1);
+	TestEqual(TEXT("Restored scale"), Resolution.GetScale(), 1.f);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLocomotionResolutionHoldTest, "ArchitectureExplorer.VRLocomotion.LocomotionResolution.Hold",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLocomotionResolutionHoldTest::RunTest(const FString& Parameters)
+{
+	FLocomotionResolution Resolution;
+	Resolution.Update(ELocomotionActivity::Aiming, FrameDeltaTime);
+
+	// Activity coming back during the hold starts it over
+	Run(Resolution, ELocomotionActivity::None, Resolution.RestoreDelay * 0.8f);
+	Resolution.Update(ELocomotionActivity::Aiming, FrameDeltaTime);
+	Run(Resolution, ELocomotionActivity::None, Resolution.RestoreDelay * 0.8f);
+	TestEqual(TEXT("Scale after an interrupted hold"), Resolution.GetScale(), Resolution.AimingScale);
+
+	// A higher scale asked for while already lower only counts as a restore
+	Resolution.Update(ELocomotionActivity::Teleporting, FrameDeltaTime);
+	Run(Resolution, ELocomotionActivity::Aiming, Resolution.RestoreDelay * 0.8f);
+	TestEqual(TEXT("Scale while aiming after a teleport, within the hold"), Resolution.GetScale(), Resolution.TeleportingScale);
+	Run(Resolution, ELocomotionActivity::Aiming, 2.f);
+	TestEqual(TEXT("Scale while aiming after a teleport, after the hold"), Resolution.GetScale(), Resolution.AimingScale);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FLocomotionResolutionClampTest, "ArchitectureExplorer.VRLocomotion.LocomotionResolution.Clamp",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FLocomotionResolutionClampTest::RunTest(const FString& Parameters)
+{
+	FLocomotionResolution Resolution;
+
+	// Activity scales above one never raise the resolution past the user's own
+	Resolution.AimingScale = 1.5f;
+	TestEqual(TEXT("Target for a scale above one"), Resolution.GetTargetScale(ELocomotionActivity::Aiming), 1.f);
+	TestEqual(TEXT("Scale above one changes nothing"), Run(Resolution, ELocomotionActivity::Aiming, 1.f), 0);
+	TestEqual(TEXT("Scale above one"), Resolution.GetScale(), 1.f);
+
+	// A long frame restores no further than the target
+	Resolution.Update(ELocomotionActivity::Climbing, FrameDeltaTime);
+	Resolution.Update(ELocomotionActivity::None, Resolution.RestoreDelay);
+	Resolution.Update(ELocomotionActivity::None, 10.f);
+	TestEqual(TEXT("Scale after a long frame"), Resolution.GetScale(), 1.f);
+
+	// Small drops are applied like any other
+	Resolution.MovingScale = 0.99f;
+	TestTrue(TEXT("A small drop reaches its target"), Resolution.Update(ELocomotionActivity::Moving, FrameDeltaTime));
+	TestEqual(TEXT("Scale after a small drop"), Resolution.GetScale(), Resolution.MovingScale);
+	return true;
+}
+
+#endif
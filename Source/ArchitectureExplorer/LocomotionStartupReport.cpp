@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LocomotionStartupReport.h"
+
+#include "ArchitectureExplorer.h"
+#include "HAL/PlatformTime.h"
+
+void FLocomotionStartupReport::Begin(float InTargetFrameSeconds)
+{
+	bRunning = true;
+	StartSeconds = FPlatformTime::Seconds();
+	TargetFrameSeconds = InTargetFrameSeconds;
+
+	Frames = 0;
+	FrameHitches = 0;
+	LocomotionHitches = 0;
+	WorstFrameSeconds = 0.f;
+	WorstFrameTime = 0.0;
+	WorstLocomotionSeconds = 0.0;
+	WorstLocomotionTime = 0.0;
+}
+
+void FLocomotionStartupReport::AddWarmUpStep(const TCHAR* Step, double Seconds)
+{
+	WarmUpSteps.Emplace(Step, Seconds);
+}
+
+void FLocomotionStartupReport::AddTick(float FrameDeltaSeconds, double LocomotionSeconds)
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	const double Time = FPlatformTime::Seconds() - StartSeconds;
+	Frames++;
+
+	// The first frame's delta includes the level load itself
+	if (Frames > 1)
+	{
+		if (TargetFrameSeconds > 0.f && FrameDeltaSeconds > TargetFrameSeconds * FrameHitchRatio)
+		{
+			FrameHitches++;
+		}
+		if (FrameDeltaSeconds > WorstFrameSeconds)
+		{
+			WorstFrameSeconds = FrameDeltaSeconds;
+			WorstFrameTime = Time;
+		}
+	}
+
+	if (LocomotionSeconds * 1000.0 > LocomotionHitchMs)
+	{
+		LocomotionHitches++;
+		UE_LOG(LogVRLocomotion, Verbose, TEXT("Locomotion hitch of %.2f ms at %.1f s"), LocomotionSeconds * 1000.0, Time);
+	}
+	if (LocomotionSeconds > WorstLocomotionSeconds)
+	{
+		WorstLocomotionSeconds = LocomotionSeconds;
+		WorstLocomotionTime = Time;
+	}
+
+	if (Time >= WindowSeconds)
+	{
+		Finish();
+	}
+}
+
+void FLocomotionStartupReport::Finish()
+{
+	bRunning = false;
+
+	double WarmUpSeconds = 0.0;
+	FString WarmUpBreakdown;
+	for (const TPair<const TCHAR*, double>& Step : WarmUpSteps)
+	{
+		WarmUpSeconds += Step.Value;
+		WarmUpBreakdown += FString::Printf(TEXT("%s%s %.2f ms"), WarmUpBreakdown.IsEmpty() ? TEXT("") : TEXT(", "), Step.Key, Step.Value * 1000.0);
+	}
+
+	UE_LOG(LogVRLocomotion, Log, TEXT("Locomotion warm-up took %.2f ms (%s)"), WarmUpSeconds * 1000.0, *WarmUpBreakdown);
+	UE_LOG(LogVRLocomotion, Log, TEXT("First %.0f s: %d frames, %d over %.2f ms (worst %.2f ms at %.1f s), %d locomotion ticks over %.2f ms (worst %.2f ms at %.1f s)"),
+		WindowSeconds, Frames, FrameHitches, TargetFrameSeconds * FrameHitchRatio * 1000.f, WorstFrameSeconds * 1000.f, WorstFrameTime,
+		LocomotionHitches, LocomotionHitchMs, WorstLocomotionSeconds * 1000.0, WorstLocomotionTime);
+}
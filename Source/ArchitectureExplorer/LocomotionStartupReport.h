@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Times the locomotion warm-up and watches the first minute of a session for hitches: frames over budget and
+ * locomotion ticks that take unusually long, e.g. from something being created or compiled on first use.
+ * Everything is logged to LogVRLocomotion as one summary once the window has passed.
+ */
+class FLocomotionStartupReport
+{
+public:
+	void Begin(float InTargetFrameSeconds);
+
+	// Records how long one warm-up step took. Step must be a string literal.
+	void AddWarmUpStep(const TCHAR* Step, double Seconds);
+
+	// Records one locomotion tick, and logs the report once the window has passed
+	void AddTick(float FrameDeltaSeconds, double LocomotionSeconds);
+
+	bool IsRunning() const { return bRunning; }
+
+public: // tuning
+	float WindowSeconds = 60.f;
+
+	// Frames longer than this many target frame times count as hitches
+	float FrameHitchRatio = 1.5f;
+
+	// Locomotion ticks longer than this count as hitches
+	float LocomotionHitchMs = 2.f;
+
+private:
+	void Finish();
+
+	bool bRunning = false;
+	double StartSeconds = 0.0;
+	float TargetFrameSeconds = 0.f;
+
+	TArray<TPair<const TCHAR*, double>, TInlineAllocator<8>> WarmUpSteps;
+
+	int32 Frames = 0;
+	int32 FrameHitches = 0;
+	int32 LocomotionHitches = 0;
+	float WorstFrameSeconds = 0.f;
+	double WorstFrameTime = 0.0;
+	double WorstLocomotionSeconds = 0.0;
+	double WorstLocomotionTime = 0.0;
+};
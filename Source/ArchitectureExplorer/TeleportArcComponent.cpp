@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TeleportArcComponent.h"
+
+#include "ArchitectureExplorer.h"
+#include "Engine/StaticMesh.h"
+
+DECLARE_CYCLE_STAT(TEXT("Teleport Arc Mesh Update"), STAT_TeleportArcMeshUpdate, STATGROUP_VRLocomotion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Teleport Arc Segment Updates"), STAT_TeleportArcSegmentUpdates, STATGROUP_VRLocomotion);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleport Arc Visible Segments"), STAT_TeleportArcVisibleSegments, STATGROUP_VRLocomotion);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleport Arc Segment Pool"), STAT_TeleportArcSegmentPool, STATGROUP_VRLocomotion);
+
+namespace
+{
+	// Unused segments collapse to nothing instead of being removed
+	const FTransform HiddenSegmentTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector);
+
+	const float SegmentTransformTolerance = 0.01f;
+}
+
+UTeleportArcComponent::UTeleportArcComponent()
+{
+	SetMobility(EComponentMobility::Movable);
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetGenerateOverlapEvents(false);
+	SetCanEverAffectNavigation(false);
+	CastShadow = false;
+}
+
+void UTeleportArcComponent::ReserveSegments(int32 NumSegments)
+{
+	if (GetInstanceCount() >= NumSegments)
+	{
+		return;
+	}
+
+	PerInstanceSMData.Reserve(NumSegments);
+	SegmentTransforms.Reserve(NumSegments);
+	while (GetInstanceCount() < NumSegments)
+	{
+		AddInstance(HiddenSegmentTransform);
+		SegmentTransforms.Add(HiddenSegmentTransform);
+	}
+	SET_DWORD_STAT(STAT_TeleportArcSegmentPool, GetInstanceCount());
+	CSV_CUSTOM_STAT(VRLocomotion, TeleportArcSegmentPool, GetInstanceCount(), ECsvCustomStatOp::Set);
+}
+
+void UTeleportArcComponent::SetArcPoints(const TArray<FVector>& WorldPoints)
+{
+	VR_LOCOMOTION_SCOPE(STAT_TeleportArcMeshUpdate, TeleportArcMeshUpdate);
+
+	UpdateMeshExtent();
+
+	const int32 NumSegments = FMath::Max(WorldPoints.Num() - 1, 0);
+	ReserveSegments(NumSegments);
+
+	// Segments past both the old and the new arc length are already hidden
+	const int32 NumSegmentsToUpdate = FMath::Max(NumSegments, NumVisibleSegments);
+	const FTransform& ComponentTransform = GetComponentTransform();
+	bool bAnySegmentChanged = false;
+
+	for (int32 i = 0; i < NumSegmentsToUpdate; i++)
+	{
+		const FTransform SegmentTransform = i < NumSegments
+			? MakeSegmentTransform(ComponentTransform.InverseTransformPosition(WorldPoints[i]), ComponentTransform.InverseTransformPosition(WorldPoints[i + 1]))
+			: HiddenSegmentTransform;
+
+		if (!SegmentTransforms[i].Equals(SegmentTransform, SegmentTransformTolerance))
+		{
+			SegmentTransforms[i] = SegmentTransform;
+			UpdateInstanceTransform(i, SegmentTransform, false, false, true);
+			INC_DWORD_STAT(STAT_TeleportArcSegmentUpdates);
+			bAnySegmentChanged = true;
+		}
+	}
+
+	// One render state update for the whole arc, and none at all if it didn't move
+	if (bAnySegmentChanged)
+	{
+		MarkRenderStateDirty();
+	}
+	NumVisibleSegments = NumSegments;
+	SET_DWORD_STAT(STAT_TeleportArcVisibleSegments, NumVisibleSegments);
+
+	if (!IsVisible())
+	{
+		SetVisibility(true);
+	}
+}
+
+void UTeleportArcComponent::HideArc()
+{
+	if (IsVisible())
+	{
+		SetVisibility(false);
+		SET_DWORD_STAT(STAT_TeleportArcVisibleSegments, 0);
+	}
+}
+
+void UTeleportArcComponent::UpdateMeshExtent()
+{
+	UStaticMesh* Mesh = GetStaticMesh();
+	if (Mesh == MeasuredMesh)
+	{
+		return;
+	}
+	MeasuredMesh = Mesh;
+
+	if (Mesh)
+	{
+		const FBox Bounds = Mesh->GetBoundingBox();
+		MeshMinX = Bounds.Min.X;
+		MeshLengthX = FMath::Max(Bounds.Max.X - Bounds.Min.X, KINDA_SMALL_NUMBER);
+	}
+
+	// Force every visible segment to be rewritten for the new extent
+	for (int32 i = 0; i < NumVisibleSegments; i++)
+	{
+		SegmentTransforms[i] = HiddenSegmentTransform;
+	}
+}
+
+// Stretches the mesh along X so that it spans exactly from Start to End
+FTransform UTeleportArcComponent::MakeSegmentTransform(const FVector& Start, const FVector& End) const
+{
+	const FVector Segment = End - Start;
+	const float Length = Segment.Size();
+	if (Length < KINDA_SMALL_NUMBER)
+	{
+		return HiddenSegmentTransform;
+	}
+
+	const FQuat Rotation = FRotationMatrix::MakeFromX(Segment).ToQuat();
+	const float ScaleX = Length / MeshLengthX;
+	const FVector Location = Start - Rotation.RotateVector(FVector(MeshMinX * ScaleX, 0.f, 0.f));
+
+	return FTransform(Rotation, Location, FVector(ScaleX, 1.f, 1.f));
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "CoreMinimal.h"
+
+#include "TeleportArcComponent.generated.h"
+
+/**
+ * Draws the whole teleport arc as instances of one mesh, one instance per path segment, so the arc costs a
+ * single component and a single draw call however long it gets. Only segments whose transform changed are
+ * rewritten, and the render state is only dirtied when something changed. Unused instances are kept at zero
+ * scale rather than removed, so the instance buffer never shrinks and regrows while aiming.
+ */
+UCLASS()
+class ARCHITECTUREEXPLORER_API UTeleportArcComponent : public UInstancedStaticMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTeleportArcComponent();
+
+	// Makes sure at least NumSegments instances exist
+	void ReserveSegments(int32 NumSegments);
+
+	// Lays the arc along the given world space path and shows it
+	void SetArcPoints(const TArray<FVector>& WorldPoints);
+
+	void HideArc();
+
+	int32 GetNumVisibleSegments() const { return NumVisibleSegments; }
+
+private:
+	void UpdateMeshExtent();
+	FTransform MakeSegmentTransform(const FVector& Start, const FVector& End) const;
+
+	// Last transform pushed per instance, in component space
+	TArray<FTransform> SegmentTransforms;
+
+	int32 NumVisibleSegments = 0;
+
+	// Extent of the mesh along X, which is stretched to each segment's length
+	UPROPERTY(Transient)
+	UStaticMesh* MeasuredMesh = nullptr;
+	float MeshMinX = 0.f;
+	float MeshLengthX = 1.f;
+};
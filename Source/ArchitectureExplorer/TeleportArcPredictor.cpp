@@ -0,0 +1,337 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TeleportArcPredictor.h"
+
+#include "ArchitectureExplorer.h"
+#include "CollisionShape.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+
+DECLARE_CYCLE_STAT(TEXT("Teleport Prediction"), STAT_TeleportPrediction, STATGROUP_VRLocomotion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Teleport Arc Sweeps"), STAT_TeleportArcSweeps, STATGROUP_VRLocomotion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Teleport Arc Async Sweeps"), STAT_TeleportArcAsyncSweeps, STATGROUP_VRLocomotion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Teleport Arc Broadphase Tests"), STAT_TeleportArcBroadphaseTests, STATGROUP_VRLocomotion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Teleport Arc Broadphase Culled Segments"), STAT_TeleportArcBroadphaseCulled, STATGROUP_VRLocomotion);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleport Arc Cache Hits"), STAT_TeleportArcCacheHits, STATGROUP_VRLocomotion);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleport Arc Cache Misses"), STAT_TeleportArcCacheMisses, STATGROUP_VRLocomotion);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleport Arc Sliced Frames"), STAT_TeleportArcSlicedFrames, STATGROUP_VRLocomotion);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Teleport Arc Cache Hit Rate"), STAT_TeleportArcCacheHitRate, STATGROUP_VRLocomotion);
+
+bool FTeleportArcPredictor::Update(UWorld* World, const FTeleportArcParams& Params)
+{
+	VR_LOCOMOTION_SCOPE(STAT_TeleportPrediction, TeleportPrediction);
+
+	if (!World)
+	{
+		return HasResult();
+	}
+
+	const float WorldTime = World->GetTimeSeconds();
+	if (!bArcInProgress)
+	{
+		if (HasResult() && !NeedsNewArc(Params, WorldTime))
+		{
+			++CacheHits;
+			INC_DWORD_STAT(STAT_TeleportArcCacheHits);
+			SET_FLOAT_STAT(STAT_TeleportArcCacheHitRate, GetCacheHitRate());
+			return true;
+		}
+		++CacheMisses;
+		INC_DWORD_STAT(STAT_TeleportArcCacheMisses);
+		BeginArc(Params, WorldTime);
+		if (bPendingAsync)
+		{
+			// Results only come back next frame
+			SubmitAsyncArc(World);
+			return HasResult();
+		}
+	}
+
+	// An arc that was started keeps its launch parameters until it completes,
+	// otherwise a constantly moving hand would never get a result when sliced.
+	const bool bArcDone = bPendingAsync ? CollectAsyncArc(World) : StepArc(World);
+	if (bArcDone)
+	{
+		CompleteArc();
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_TeleportArcSlicedFrames);
+	}
+	SET_FLOAT_STAT(STAT_TeleportArcCacheHitRate, GetCacheHitRate());
+
+	return HasResult();
+}
+
+void FTeleportArcPredictor::Invalidate()
+{
+	bInvalidated = true;
+}
+
+void FTeleportArcPredictor::Reserve(const FTeleportArcParams& Params)
+{
+	const int32 MaxPoints = GetMaxPathPoints(Params);
+	Result.PathPoints.Reserve(MaxPoints);
+	Pending.PathPoints.Reserve(MaxPoints);
+	Samples.Reserve(MaxPoints);
+	AsyncTraceHandles.Reserve(MaxPoints);
+}
+
+int32 FTeleportArcPredictor::GetMaxPathPoints(const FTeleportArcParams& Params)
+{
+	// Start point, one point per substep, and the impact point
+	return FMath::CeilToInt(Params.MaxSimTime * FMath::Max(Params.SimFrequency, 1.f)) + 2;
+}
+
+float FTeleportArcPredictor::GetCacheHitRate() const
+{
+	const uint64 Total = CacheHits + CacheMisses;
+	return Total > 0 ? float(double(CacheHits) / double(Total)) : 0.f;
+}
+
+bool FTeleportArcPredictor::NeedsNewArc(const FTeleportArcParams& Params, float WorldTime) const
+{
+	if (bInvalidated || (MaxResultAge > 0.f && WorldTime - ResultTime > MaxResultAge))
+	{
+		return true;
+	}
+
+	if (Params.TraceChannel != ResultParams.TraceChannel
+		|| Params.bTraceComplex != ResultParams.bTraceComplex
+		|| Params.IgnoredActor != ResultParams.IgnoredActor
+		|| Params.ProjectileRadius != ResultParams.ProjectileRadius
+		|| Params.SimFrequency != ResultParams.SimFrequency
+		|| Params.MaxSimTime != ResultParams.MaxSimTime)
+	{
+		return true;
+	}
+
+	if (!Params.StartLocation.Equals(ResultParams.StartLocation, LocationTolerance))
+	{
+		return true;
+	}
+
+	const float ResultSpeed = ResultParams.LaunchVelocity.Size();
+	if (FMath::Abs(Params.LaunchVelocity.Size() - ResultSpeed) > SpeedTolerance * ResultSpeed)
+	{
+		return true;
+	}
+
+	const float CosTolerance = FMath::Cos(FMath::DegreesToRadians(DirectionToleranceDegrees));
+	return FVector::DotProduct(Params.LaunchVelocity.GetSafeNormal(), ResultParams.LaunchVelocity.GetSafeNormal()) < CosTolerance;
+}
+
+void FTeleportArcPredictor::BeginArc(const FTeleportArcParams& Params, float WorldTime)
+{
+	bArcInProgress = true;
+	bPendingAsync = bAsyncTraces;
+	bPendingBroadphase = bBroadphase && !bAsyncTraces;
+	NextSegment = INDEX_NONE;
+	bInvalidated = false;
+	PendingParams = Params;
+	PendingStartTime = WorldTime;
+
+	Pending.PathPoints.Reset();
+	Pending.PathPoints.Add(Params.StartLocation);
+	Pending.HitResult = FHitResult();
+	Pending.bBlockingHit = false;
+
+	PendingQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(TeleportArc), Params.bTraceComplex, Params.IgnoredActor);
+
+	TraceEnd = Params.StartLocation;
+	Velocity = Params.LaunchVelocity;
+	SimTime = 0.f;
+}
+
+// Mirrors the stepping of UGameplayStatics::PredictProjectilePath, but can stop at any substep
+// and pick up from there on the next call. Returns true once the arc is finished.
+bool FTeleportArcPredictor::StepArc(UWorld* World)
+{
+	if (bPendingBroadphase)
+	{
+		return StepArcBroadphase(World);
+	}
+
+	const double Deadline = FPlatformTime::Seconds() + FrameBudgetMs / 1000.0;
+	const float SubstepDeltaTime = 1.f / FMath::Max(PendingParams.SimFrequency, 1.f);
+	const float GravityZ = World->GetGravityZ();
+	const bool bSweep = PendingParams.ProjectileRadius > 0.f;
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(PendingParams.ProjectileRadius);
+
+	while (SimTime < PendingParams.MaxSimTime)
+	{
+		const float StepDeltaTime = FMath::Min(PendingParams.MaxSimTime - SimTime, SubstepDeltaTime);
+		SimTime += StepDeltaTime;
+
+		const FVector OldVelocity = Velocity;
+		Velocity = OldVelocity + FVector(0.f, 0.f, GravityZ * StepDeltaTime);
+		const FVector TraceStart = TraceEnd;
+		TraceEnd = TraceStart + (OldVelocity + Velocity) * (0.5f * StepDeltaTime);
+
+		FHitResult Hit;
+		const bool bHit = bSweep
+			? World->SweepSingleByChannel(OUT Hit, TraceStart, TraceEnd, FQuat::Identity, PendingParams.TraceChannel, Shape, PendingQueryParams)
+			: World->LineTraceSingleByChannel(OUT Hit, TraceStart, TraceEnd, PendingParams.TraceChannel, PendingQueryParams);
+		++PhysicsQueries;
+		INC_DWORD_STAT(STAT_TeleportArcSweeps);
+
+		if (bHit)
+		{
+			Pending.HitResult = Hit;
+			Pending.bBlockingHit = true;
+			Pending.PathPoints.Add(Hit.Location);
+			return true;
+		}
+		Pending.PathPoints.Add(TraceEnd);
+
+		// Always make at least one substep of progress so a tiny budget still converges
+		if (FPlatformTime::Seconds() >= Deadline)
+		{
+			break;
+		}
+	}
+
+	return SimTime >= PendingParams.MaxSimTime;
+}
+
+// Same arc as StepArc, but the points come from the closed form and chunks of segments that can't hit
+// anything are skipped after one overlap test of their bounds. Segments are straight chords between
+// samples, so the chunk bounds grown by the radius contain every sweep of the chunk.
+bool FTeleportArcPredictor::StepArcBroadphase(UWorld* World)
+{
+	if (NextSegment == INDEX_NONE)
+	{
+		Samples.Evaluate(PendingParams, World->GetGravityZ());
+		NextSegment = 0;
+	}
+
+	const double Deadline = FPlatformTime::Seconds() + FrameBudgetMs / 1000.0;
+	const bool bSweep = PendingParams.ProjectileRadius > 0.f;
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(PendingParams.ProjectileRadius);
+	const int32 NumSegments = Samples.Num() - 1;
+
+	while (NextSegment < NumSegments)
+	{
+		const int32 ChunkEnd = FMath::Min(NextSegment + FMath::Max(BroadphaseChunkSegments, 1), NumSegments);
+		const FBox ChunkBounds = Samples.GetBounds(NextSegment, ChunkEnd, PendingParams.ProjectileRadius);
+		const bool bChunkMayHit = World->OverlapAnyTestByChannel(ChunkBounds.GetCenter(), FQuat::Identity, PendingParams.TraceChannel,
+			FCollisionShape::MakeBox(ChunkBounds.GetExtent()), PendingQueryParams);
+		++PhysicsQueries;
+		INC_DWORD_STAT(STAT_TeleportArcBroadphaseTests);
+
+		for (int32 Segment = NextSegment; Segment < ChunkEnd; ++Segment)
+		{
+			const FVector SegmentEnd = Samples.GetPoint(Segment + 1);
+			if (bChunkMayHit)
+			{
+				const FVector SegmentStart = Samples.GetPoint(Segment);
+				FHitResult Hit;
+				const bool bHit = bSweep
+					? World->SweepSingleByChannel(OUT Hit, SegmentStart, SegmentEnd, FQuat::Identity, PendingParams.TraceChannel, Shape, PendingQueryParams)
+					: World->LineTraceSingleByChannel(OUT Hit, SegmentStart, SegmentEnd, PendingParams.TraceChannel, PendingQueryParams);
+				++PhysicsQueries;
+				INC_DWORD_STAT(STAT_TeleportArcSweeps);
+
+				if (bHit)
+				{
+					Pending.HitResult = Hit;
+					Pending.bBlockingHit = true;
+					Pending.PathPoints.Add(Hit.Location);
+					return true;
+				}
+			}
+			else
+			{
+				INC_DWORD_STAT(STAT_TeleportArcBroadphaseCulled);
+			}
+			Pending.PathPoints.Add(SegmentEnd);
+		}
+		NextSegment = ChunkEnd;
+
+		// Always finish at least one chunk so a tiny budget still converges
+		if (FPlatformTime::Seconds() >= Deadline)
+		{
+			break;
+		}
+	}
+
+	return NextSegment >= NumSegments;
+}
+
+// Lays out the arc without collision and queues one async sweep per segment. Gravity is the only
+// force on the projectile, so the segments match what StepArc would sweep.
+void FTeleportArcPredictor::SubmitAsyncArc(UWorld* World)
+{
+	const float SubstepDeltaTime = 1.f / FMath::Max(PendingParams.SimFrequency, 1.f);
+	const float GravityZ = World->GetGravityZ();
+	const bool bSweep = PendingParams.ProjectileRadius > 0.f;
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(PendingParams.ProjectileRadius);
+
+	AsyncTraceHandles.Reset();
+	AsyncSubmitFrame = GFrameCounter;
+
+	while (SimTime < PendingParams.MaxSimTime)
+	{
+		const float StepDeltaTime = FMath::Min(PendingParams.MaxSimTime - SimTime, SubstepDeltaTime);
+		SimTime += StepDeltaTime;
+
+		const FVector OldVelocity = Velocity;
+		Velocity = OldVelocity + FVector(0.f, 0.f, GravityZ * StepDeltaTime);
+		const FVector TraceStart = TraceEnd;
+		TraceEnd = TraceStart + (OldVelocity + Velocity) * (0.5f * StepDeltaTime);
+
+		const FTraceHandle Handle = bSweep
+			? World->AsyncSweepByChannel(EAsyncTraceType::Single, TraceStart, TraceEnd, FQuat::Identity, PendingParams.TraceChannel, Shape, PendingQueryParams)
+			: World->AsyncLineTraceByChannel(EAsyncTraceType::Single, TraceStart, TraceEnd, PendingParams.TraceChannel, PendingQueryParams);
+		AsyncTraceHandles.Add(Handle);
+		Pending.PathPoints.Add(TraceEnd);
+		++PhysicsQueries;
+		INC_DWORD_STAT(STAT_TeleportArcAsyncSweeps);
+	}
+}
+
+// Returns true once the results of the submitted batch have been folded into the pending arc
+bool FTeleportArcPredictor::CollectAsyncArc(UWorld* World)
+{
+	for (int32 Segment = 0; Segment < AsyncTraceHandles.Num(); ++Segment)
+	{
+		FTraceDatum Datum;
+		if (!World->QueryTraceData(AsyncTraceHandles[Segment], OUT Datum))
+		{
+			// The world keeps async results for the frame after they were requested only. If we missed them,
+			// trace the arc again.
+			if (GFrameCounter > AsyncSubmitFrame + 1)
+			{
+				BeginArc(PendingParams, PendingStartTime);
+				SubmitAsyncArc(World);
+			}
+			return false;
+		}
+
+		const FHitResult* Hit = FHitResult::GetFirstBlockingHit(Datum.OutHits);
+		if (Hit)
+		{
+			// Path keeps the start of the hit segment, then ends at the impact
+			Pending.PathPoints.SetNum(Segment + 1, false);
+			Pending.PathPoints.Add(Hit->Location);
+			Pending.HitResult = *Hit;
+			Pending.bBlockingHit = true;
+			return true;
+		}
+	}
+	return true;
+}
+
+void FTeleportArcPredictor::CompleteArc()
+{
+	bArcInProgress = false;
+
+	// Swap rather than copy so both path buffers keep their allocations
+	Swap(Result.PathPoints, Pending.PathPoints);
+	Result.HitResult = Pending.HitResult;
+	Result.bBlockingHit = Pending.bBlockingHit;
+	Result.Serial = NextSerial++;
+
+	ResultParams = PendingParams;
+	ResultTime = PendingStartTime;
+}
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CollisionQueryParams.h"
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "TeleportArcSamples.h"
+#include "WorldCollision.h"
+
+class AActor;
+class UWorld;
+
+// Launch description of a teleport arc
+struct FTeleportArcParams
+{
+	FVector StartLocation = FVector::ZeroVector;
+	FVector LaunchVelocity = FVector::ZeroVector;
+	float ProjectileRadius = 0.f;
+	float SimFrequency = 20.f;
+	float MaxSimTime = 5.f;
+	ECollisionChannel TraceChannel = ECC_Visibility;
+	bool bTraceComplex = true;
+	const AActor* IgnoredActor = nullptr;
+};
+
+// A fully traced teleport arc
+struct FTeleportArcResult
+{
+	TArray<FVector> PathPoints;
+	FHitResult HitResult;
+	bool bBlockingHit = false;
+
+	// Bumped every time a new arc completes, so callers can cache work derived from it
+	uint32 Serial = 0;
+};
+
+/**
+ * Predicts the teleport arc incrementally instead of running a full projectile prediction every frame.
+ * A new arc is only traced when the launch location or direction moves beyond tolerance (or the last
+ * result gets too old), and the sweep chain is spread over several frames when it exceeds the frame budget.
+ * Until a new arc completes, the last completed one is reused.
+ *
+ * In async mode the whole arc is submitted as one batch of segment sweeps through the world's async
+ * trace queue and consumed on the next frame, so the game thread never waits on the traces. The latency
+ * is fixed at one frame: the world only keeps a frame's results until the end of the next frame, so a
+ * batch whose results were missed is submitted again rather than waited for.
+ *
+ * With the broadphase on, a synchronous arc is laid out in closed form up front and walked in chunks of
+ * segments. Each chunk's bounds get one overlap test, and only chunks that overlap something are swept
+ * segment by segment, so arcs flying through open space cost a fraction of the queries.
+ */
+class FTeleportArcPredictor
+{
+public:
+	// Advances prediction. Returns true when GetResult() holds a completed arc.
+	bool Update(UWorld* World, const FTeleportArcParams& Params);
+
+	// Forces the next Update to trace a new arc
+	void Invalidate();
+
+	// Pre-sizes the path buffers for the longest arc Params can produce, so tracing never allocates
+	void Reserve(const FTeleportArcParams& Params);
+
+	// Number of path points of the longest arc Params can produce
+	static int32 GetMaxPathPoints(const FTeleportArcParams& Params);
+
+	bool HasResult() const { return Result.Serial != 0; }
+	const FTeleportArcResult& GetResult() const { return Result; }
+
+	uint64 GetCacheHits() const { return CacheHits; }
+	uint64 GetCacheMisses() const { return CacheMisses; }
+	float GetCacheHitRate() const;
+
+	// Sweeps, line traces and broadphase overlap tests issued so far
+	uint64 GetPhysicsQueries() const { return PhysicsQueries; }
+
+public: // tuning
+	// Launch location change (cm) that still reuses the last arc
+	float LocationTolerance = 1.f;
+
+	// Launch direction change (degrees) that still reuses the last arc
+	float DirectionToleranceDegrees = 0.5f;
+
+	// Launch speed change, as a fraction of the last arc's speed, that still reuses it
+	float SpeedTolerance = 0.001f;
+
+	// Seconds after which an arc is retraced even if the hand is still. Zero never expires.
+	float MaxResultAge = 0.5f;
+
+	// Game thread time a single Update may spend sweeping before continuing next frame
+	float FrameBudgetMs = 0.5f;
+
+	// Trace through the async trace queue, at the cost of one frame of latency
+	bool bAsyncTraces = false;
+
+	// Skip sweeping chunks of the arc whose bounds don't overlap anything
+	bool bBroadphase = true;
+
+	// Segments per broadphase overlap test
+	int32 BroadphaseChunkSegments = 8;
+
+private:
+	bool NeedsNewArc(const FTeleportArcParams& Params, float WorldTime) const;
+	void BeginArc(const FTeleportArcParams& Params, float WorldTime);
+	bool StepArc(UWorld* World);
+	bool StepArcBroadphase(UWorld* World);
+	void SubmitAsyncArc(UWorld* World);
+	bool CollectAsyncArc(UWorld* World);
+	void CompleteArc();
+
+	FTeleportArcResult Result;
+	FTeleportArcParams ResultParams;
+	float ResultTime = 0.f;
+	bool bInvalidated = false;
+
+	// Arc currently being traced, possibly across several frames
+	bool bArcInProgress = false;
+	FTeleportArcParams PendingParams;
+	FTeleportArcResult Pending;
+	FCollisionQueryParams PendingQueryParams;
+	float PendingStartTime = 0.f;
+	FVector TraceEnd = FVector::ZeroVector;
+	FVector Velocity = FVector::ZeroVector;
+	float SimTime = 0.f;
+
+	// Closed form samples of the pending arc, walked from NextSegment. INDEX_NONE until evaluated.
+	bool bPendingBroadphase = false;
+	FTeleportArcSamples Samples;
+	int32 NextSegment = INDEX_NONE;
+
+	// Async segment sweeps of the pending arc, one per path segment
+	bool bPendingAsync = false;
+	TArray<FTraceHandle> AsyncTraceHandles;
+	uint64 AsyncSubmitFrame = 0;
+
+	uint32 NextSerial = 1;
+	uint64 CacheHits = 0;
+	uint64 CacheMisses = 0;
+	uint64 PhysicsQueries = 0;
+};
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TeleportArcQuality.h"
+
+#include "ArchitectureExplorer.h"
+#include "HAL/PlatformTime.h"
+#include "RHI.h"
+#include "TeleportArcPredictor.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleport Arc Quality Tier"), STAT_TeleportArcQualityTier, STATGROUP_VRLocomotion);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Teleport Arc Smoothed Frame Ms"), STAT_TeleportArcSmoothedFrameMs, STATGROUP_VRLocomotion);
+
+namespace
+{
+	struct FQualityTier
+	{
+		float SimFrequencyScale;
+		float MaxSimTimeScale;
+		float RadiusScale;
+	};
+
+	// Full quality first. The last tier traces lines instead of sweeping a sphere.
+	const FQualityTier QualityTiers[] =
+	{
+		{1.f, 1.f, 1.f},
+		{0.75f, 1.f, 1.f},
+		{0.5f, 0.8f, 0.5f},
+		{0.3f, 0.6f, 0.f},
+	};
+}
+
+bool FTeleportArcQuality::Update(float FrameWorkSeconds, float TargetFrameSeconds)
+{
+	SmoothedFrameSeconds = SmoothedFrameSeconds > 0.f
+		? FMath::Lerp(SmoothedFrameSeconds, FrameWorkSeconds, SmoothingFactor)
+		: FrameWorkSeconds;
+	SET_FLOAT_STAT(STAT_TeleportArcSmoothedFrameMs, SmoothedFrameSeconds * 1000.f);
+
+	if (++FramesSinceChange < HoldFrames || TargetFrameSeconds <= 0.f)
+	{
+		return false;
+	}
+
+	const float Load = SmoothedFrameSeconds / TargetFrameSeconds;
+	int32 NewTier = Tier;
+	if (Load > DownshiftRatio)
+	{
+		NewTier = FMath::Min(Tier + 1, GetNumTiers() - 1);
+	}
+	else if (Load < UpshiftRatio)
+	{
+		NewTier = FMath::Max(Tier - 1, 0);
+	}
+	if (NewTier == Tier)
+	{
+		return false;
+	}
+
+	UE_LOG(LogVRLocomotion, Verbose, TEXT("Teleport arc quality tier %d -> %d at %.2f ms for a %.2f ms target"),
+		Tier, NewTier, SmoothedFrameSeconds * 1000.f, TargetFrameSeconds * 1000.f);
+	Tier = NewTier;
+	FramesSinceChange = 0;
+	SET_DWORD_STAT(STAT_TeleportArcQualityTier, Tier);
+	CSV_CUSTOM_STAT(VRLocomotion, TeleportArcQualityTier, Tier, ECsvCustomStatOp::Set);
+	return true;
+}
+
+void FTeleportArcQuality::Apply(FTeleportArcParams& Params) const
+{
+	const FQualityTier& QualityTier = QualityTiers[Tier];
+	Params.SimFrequency *= QualityTier.SimFrequencyScale;
+	Params.MaxSimTime *= QualityTier.MaxSimTimeScale;
+	Params.ProjectileRadius *= QualityTier.RadiusScale;
+}
+
+int32 FTeleportArcQuality::GetNumTiers()
+{
+	return int32(UE_ARRAY_COUNT(QualityTiers));
+}
+
+float FTeleportArcQuality::GetFrameWorkSeconds()
+{
+	const uint32 FrameCycles = FMath::Max3(GGameThreadTime, GRenderThreadTime, RHIGetGPUFrameCycles());
+	return float(FPlatformTime::ToSeconds(FrameCycles));
+}
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FTeleportArcParams;
+
+/**
+ * Scales teleport arc fidelity with frame headroom. The frame's work time (the slowest of game thread, render
+ * thread and GPU, as in stat unit) is smoothed and compared against the target frame time: when it runs close
+ * to the target the arc drops a tier, and when there is plenty of headroom again it climbs back up. Lower tiers
+ * step the projectile less often, shorten its flight and shrink the sweep radius, down to plain line traces.
+ * Tiers only change after a hold period so the arc doesn't flicker between them.
+ */
+class FTeleportArcQuality
+{
+public:
+	// Feeds one frame's work time. Returns true when the tier changed.
+	bool Update(float FrameWorkSeconds, float TargetFrameSeconds);
+
+	// Scales full quality arc params down to the current tier
+	void Apply(FTeleportArcParams& Params) const;
+
+	// 0 is full quality, higher is cheaper
+	int32 GetTier() const { return Tier; }
+	static int32 GetNumTiers();
+
+	float GetSmoothedFrameSeconds() const { return SmoothedFrameSeconds; }
+
+	// Work time of the last frame, excluding time spent waiting on vsync or other threads
+	static float GetFrameWorkSeconds();
+
+public: // tuning
+	// Drop a tier when the smoothed frame time is above this fraction of the target
+	float DownshiftRatio = 0.9f;
+
+	// Climb a tier when the smoothed frame time is below this fraction of the target
+	float UpshiftRatio = 0.7f;
+
+	// Weight of each new frame in the smoothed frame time
+	float SmoothingFactor = 0.1f;
+
+	// Frames to wait after a change before the tier may change again
+	int32 HoldFrames = 45;
+
+private:
+	float SmoothedFrameSeconds = 0.f;
+	int32 Tier = 0;
+	int32 FramesSinceChange = 0;
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TeleportArcSamples.h"
+
+#include "TeleportArcPredictor.h"
+
+void FTeleportArcSamples::Evaluate(const FTeleportArcParams& Params, float GravityZ)
+{
+	const float SubstepDeltaTime = 1.f / FMath::Max(Params.SimFrequency, 1.f);
+	const float MaxSimTime = FMath::Max(Params.MaxSimTime, 0.f);
+	const int32 NumPoints = FMath::CeilToInt(MaxSimTime / SubstepDeltaTime) + 1;
+
+	Time.SetNumUninitialized(NumPoints, false);
+	X.SetNumUninitialized(NumPoints, false);
+	Y.SetNumUninitialized(NumPoints, false);
+	Z.SetNumUninitialized(NumPoints, false);
+
+	// The last substep is cut short to end exactly at MaxSimTime
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		Time[i] = FMath::Min(i * SubstepDeltaTime, MaxSimTime);
+	}
+
+	// p(t) = p0 + v0 t + g t^2 / 2, one straight loop per axis
+	const FVector Start = Params.StartLocation;
+	const FVector Velocity = Params.LaunchVelocity;
+	const float HalfGravityZ = 0.5f * GravityZ;
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		X[i] = Start.X + Velocity.X * Time[i];
+	}
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		Y[i] = Start.Y + Velocity.Y * Time[i];
+	}
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		Z[i] = Start.Z + (Velocity.Z + HalfGravityZ * Time[i]) * Time[i];
+	}
+}
+
+void FTeleportArcSamples::Reserve(int32 NumPoints)
+{
+	Time.Reserve(NumPoints);
+	X.Reserve(NumPoints);
+	Y.Reserve(NumPoints);
+	Z.Reserve(NumPoints);
+}
+
+FBox FTeleportArcSamples::GetBounds(int32 First, int32 Last, float Radius) const
+{
+	FVector Min(X[First], Y[First], Z[First]);
+	FVector Max = Min;
+	for (int32 i = First + 1; i <= Last; i++)
+	{
+		Min.X = FMath::Min(Min.X, X[i]);
+		Min.Y = FMath::Min(Min.Y, Y[i]);
+		Min.Z = FMath::Min(Min.Z, Z[i]);
+		Max.X = FMath::Max(Max.X, X[i]);
+		Max.Y = FMath::Max(Max.Y, Y[i]);
+		Max.Z = FMath::Max(Max.Z, Z[i]);
+	}
+	return FBox(Min, Max).ExpandBy(Radius);
+}
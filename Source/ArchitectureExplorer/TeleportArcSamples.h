@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FTeleportArcParams;
+
+/**
+ * Sample points of a ballistic teleport arc, evaluated in closed form rather than stepped. Positions are kept as
+ * separate X, Y and Z arrays and every point is independent of the others, so the evaluation loops vectorize.
+ * The samples land on the same substep times PredictProjectilePath uses.
+ */
+struct FTeleportArcSamples
+{
+	// Evaluates every substep of the arc Params describes under GravityZ
+	void Evaluate(const FTeleportArcParams& Params, float GravityZ);
+
+	void Reserve(int32 NumPoints);
+
+	int32 Num() const { return X.Num(); }
+	FVector GetPoint(int32 Index) const { return FVector(X[Index], Y[Index], Z[Index]); }
+
+	// Bounds of the points First..Last (inclusive), grown by Radius
+	FBox GetBounds(int32 First, int32 Last, float Radius) const;
+
+	TArray<float> Time;
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+};
@@ -0,0 +1,375 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ArchitectureExplorer.h"
+#include "Components/BoxComponent.h"
+#include "CountingMalloc.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/World.h"
+#include "HandController.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "NavigationSystem.h"
+#include "TeleportArcComponent.h"
+#include "TeleportArcPredictor.h"
+#include "TeleportArcSamples.h"
+#include "VRCharacter.h"
+#include "VRSessionRecording.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	UBoxComponent* AddBlockingBox(AActor* Owner, const TCHAR* Name, const FVector& Center, const FVector& Extent)
+	{
+		UBoxComponent* Box = NewObject<UBoxComponent>(Owner, Name);
+		Box->SetBoxExtent(Extent, false);
+		Box->SetWorldLocation(Center);
+		Box->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		if (Owner->GetRootComponent())
+		{
+			Box->SetupAttachment(Owner->GetRootComponent());
+		}
+		else
+		{
+			Owner->SetRootComponent(Box);
+		}
+		Box->RegisterComponent();
+		return Box;
+	}
+
+	// A game world with nothing in it but a floor at Z = 0
+	UWorld* CreateFloorWorld()
+	{
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+		AActor* Floor = World->SpawnActor<AActor>();
+		AddBlockingBox(Floor, TEXT("Floor"), FVector(0.f, 0.f, -10.f), FVector(100000.f, 100000.f, 10.f));
+		return World;
+	}
+
+	// The floor world with a room around the origin: walls, a raised platform, a pillar and a low ceiling beam,
+	// so arcs end on surfaces facing every way
+	UWorld* CreateRoomWorld()
+	{
+		UWorld* World = CreateFloorWorld();
+		AActor* Room = World->SpawnActor<AActor>();
+		AddBlockingBox(Room, TEXT("NorthWall"), FVector(800.f, 0.f, 200.f), FVector(10.f, 800.f, 200.f));
+		AddBlockingBox(Room, TEXT("SouthWall"), FVector(-800.f, 0.f, 200.f), FVector(10.f, 800.f, 200.f));
+		AddBlockingBox(Room, TEXT("EastWall"), FVector(0.f, 800.f, 200.f), FVector(800.f, 10.f, 200.f));
+		AddBlockingBox(Room, TEXT("WestWall"), FVector(0.f, -800.f, 200.f), FVector(800.f, 10.f, 200.f));
+		AddBlockingBox(Room, TEXT("Platform"), FVector(350.f, 250.f, 20.f), FVector(150.f, 150.f, 20.f));
+		AddBlockingBox(Room, TEXT("Pillar"), FVector(-250.f, 300.f, 200.f), FVector(30.f, 30.f, 200.f));
+		AddBlockingBox(Room, TEXT("Beam"), FVector(0.f, -350.f, 260.f), FVector(800.f, 20.f, 20.f));
+		return World;
+	}
+
+	void DestroyWorld(UWorld* World)
+	{
+		World->DestroyWorld(false);
+		World->RemoveFromRoot();
+	}
+
+	// Arc launched from head height, turning a little each frame so every frame traces a new one
+	FTeleportArcParams MakeArcParams(int32 Frame)
+	{
+		FTeleportArcParams Params;
+		Params.StartLocation = FVector(0.f, 0.f, 150.f);
+		Params.LaunchVelocity = FRotator(-20.f, Frame * 3.f, 0.f).Vector() * 1000.f;
+		Params.ProjectileRadius = 5.f;
+		Params.TraceChannel = ECC_WorldStatic;
+		Params.bTraceComplex = false;
+		return Params;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTeleportArcAllocationTest, "ArchitectureExplorer.VRLocomotion.TeleportArc.NoSteadyStateAllocations",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FTeleportArcAllocationTest::RunTest(const FString& Parameters)
+{
+	const int32 WarmUpFrames = 10;
+	const int32 NumFrames = 200;
+
+	UWorld* World = CreateFloorWorld();
+	AActor* ArcActor = World->SpawnActor<AActor>();
+	UTeleportArcComponent* Arc = NewObject<UTeleportArcComponent>(ArcActor, TEXT("Arc"));
+	ArcActor->SetRootComponent(Arc);
+	Arc->RegisterComponent();
+
+	for (const bool bBroadphase : { false, true })
+	{
+		FTeleportArcPredictor Predictor;
+		Predictor.bBroadphase = bBroadphase;
+		Predictor.MaxResultAge = 0.f;
+		Predictor.FrameBudgetMs = 1000.f;
+		Predictor.Reserve(MakeArcParams(0));
+		Arc->ReserveSegments(FTeleportArcPredictor::GetMaxPathPoints(MakeArcParams(0)) - 1);
+
+		FCountingMalloc* CountingMalloc = nullptr;
+		uint64 StartAllocations = 0;
+		int32 NumHits = 0;
+		for (int32 Frame = 0; Frame < WarmUpFrames + NumFrames; Frame++)
+		{
+			if (Frame == WarmUpFrames)
+			{
+				CountingMalloc = FCountingMalloc::Install();
+				StartAllocations = CountingMalloc->GetGameThreadAllocations();
+			}
+			if (Predictor.Update(World, MakeArcParams(Frame)) && Predictor.GetResult().bBlockingHit)
+			{
+				Arc->SetArcPoints(Predictor.GetResult().PathPoints);
+				NumHits++;
+			}
+			else
+			{
+				Arc->HideArc();
+			}
+		}
+		const uint64 Allocations = CountingMalloc->GetGameThreadAllocations() - StartAllocations;
+		CountingMalloc->Uninstall();
+
+		const TCHAR* Mode = bBroadphase ? TEXT("broadphase") : TEXT("stepped");
+		TestEqual(*FString::Printf(TEXT("Arcs hitting the floor (%s)"), Mode), NumHits, WarmUpFrames + NumFrames);
+		TestEqual(*FString::Printf(TEXT("Game thread allocations over %d frames (%s)"), NumFrames, Mode), int64(Allocations), int64(0));
+	}
+
+	DestroyWorld(World);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTeleportArcAsyncTest, "ArchitectureExplorer.VRLocomotion.TeleportArc.AsyncMatchesSync",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FTeleportArcAsyncTest::RunTest(const FString& Parameters)
+{
+	// Distance (cm) between the sync and async impact points that still counts as the same arc
+	const float HitTolerance = 1.f;
+	const float DeltaTime = 1.f / 90.f;
+
+	UWorld* World = CreateFloorWorld();
+	for (int32 Frame = 0; Frame < 120; Frame += 10)
+	{
+		const FTeleportArcParams Params = MakeArcParams(Frame);
+
+		FTeleportArcPredictor Sync;
+		Sync.FrameBudgetMs = 1000.f;
+		Sync.bBroadphase = false;
+		Sync.Update(World, Params);
+
+		// Submitted on the first update, collected once the world has ticked
+		FTeleportArcPredictor Async;
+		Async.bAsyncTraces = true;
+		Async.Update(World, Params);
+		for (int32 Tick = 0; Tick < 4 && !Async.HasResult(); Tick++)
+		{
+			World->Tick(LEVELTICK_All, DeltaTime);
+			Async.Update(World, Params);
+		}
+
+		if (!TestTrue(*FString::Printf(TEXT("Async arc %d completed"), Frame), Async.HasResult()))
+		{
+			continue;
+		}
+		const FTeleportArcResult& SyncResult = Sync.GetResult();
+		const FTeleportArcResult& AsyncResult = Async.GetResult();
+		TestEqual(*FString::Printf(TEXT("Arc %d hit"), Frame), AsyncResult.bBlockingHit, SyncResult.bBlockingHit);
+		TestEqual(*FString::Printf(TEXT("Arc %d points"), Frame), AsyncResult.PathPoints.Num(), SyncResult.PathPoints.Num());
+		TestTrue(*FString::Printf(TEXT("Arc %d hit location"), Frame),
+			FVector::Dist(AsyncResult.HitResult.Location, SyncResult.HitResult.Location) <= HitTolerance);
+	}
+
+	DestroyWorld(World);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTeleportArcSamplesTest, "ArchitectureExplorer.VRLocomotion.TeleportArc.SamplesMatchPredictProjectilePath",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FTeleportArcSamplesTest::RunTest(const FString& Parameters)
+{
+	// Distance (cm) between a closed form sample and the stepped point at the same substep
+	const float SampleTolerance = 1.f;
+
+	UWorld* World = CreateFloorWorld();
+	FTeleportArcSamples Samples;
+	for (const float GravityZ : { -490.f, -980.f, -1960.f })
+	{
+		for (const float Pitch : { -45.f, -10.f, 0.f, 30.f, 60.f })
+		{
+			FTeleportArcParams Params;
+			Params.StartLocation = FVector(120.f, -40.f, 150.f);
+			Params.LaunchVelocity = FRotator(Pitch, 35.f, 0.f).Vector() * 1000.f;
+			Params.SimFrequency = 20.f;
+			Params.MaxSimTime = 2.f;
+			Samples.Evaluate(Params, GravityZ);
+
+			FPredictProjectilePathParams ReferenceParams(0.f, Params.StartLocation, Params.LaunchVelocity, Params.MaxSimTime);
+			ReferenceParams.SimFrequency = Params.SimFrequency;
+			ReferenceParams.OverrideGravityZ = GravityZ;
+			ReferenceParams.bTraceWithCollision = false;
+			FPredictProjectilePathResult Reference;
+			UGameplayStatics::PredictProjectilePath(World, ReferenceParams, Reference);
+
+			// Stepped time can run a rounding error past the last substep and add a vanishing extra point
+			const FString Case = FString::Printf(TEXT("gravity %.0f, pitch %.0f"), GravityZ, Pitch);
+			TestTrue(*FString::Printf(TEXT("Sample count (%s)"), *Case), FMath::Abs(Samples.Num() - Reference.PathData.Num()) <= 1);
+
+			float MaxError = 0.f;
+			for (int32 i = 0; i < FMath::Min(Samples.Num(), Reference.PathData.Num()); i++)
+			{
+				MaxError = FMath::Max(MaxError, FVector::Dist(Samples.GetPoint(i), Reference.PathData[i].Location));
+			}
+			TestTrue(*FString::Printf(TEXT("Largest sample error %.3f cm (%s)"), MaxError, *Case), MaxError < SampleTolerance);
+		}
+	}
+
+	DestroyWorld(World);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTeleportArcBroadphaseTest, "ArchitectureExplorer.VRLocomotion.TeleportArc.BroadphaseMatchesPredictProjectilePath",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FTeleportArcBroadphaseTest::RunTest(const FString& Parameters)
+{
+	// Distance (cm) between the broadphase and reference impact points or end points that still counts as the same arc
+	const float LocationTolerance = 1.f;
+	// Largest difference between the broadphase and reference impact normals
+	const float NormalTolerance = 0.01f;
+	const float ProjectileSpeed = 1000.f;
+
+	// Recorded aiming, with the VR root at the origin of the room
+	const FString SessionFilename = FPaths::ProjectContentDir() / TEXT("VRSessions/AimSweep.vrsession");
+	FVRSessionReplay Session;
+	if (!Session.Open(SessionFilename))
+	{
+		AddError(FString::Printf(TEXT("Could not open %s"), *SessionFilename));
+		return false;
+	}
+
+	UWorld* World = CreateRoomWorld();
+	FTeleportArcPredictor Broadphase;
+	Broadphase.bBroadphase = true;
+	Broadphase.MaxResultAge = 0.f;
+	Broadphase.FrameBudgetMs = 1000.f;
+
+	int32 NumHits = 0;
+	int32 NumMismatches = 0;
+	for (int32 Frame = 0; Frame < Session.GetNumFrames(); Frame++)
+	{
+		const FTransform Hand = Session.GetFrame(Frame).GetLeftHand();
+		FTeleportArcParams Params;
+		Params.StartLocation = Hand.GetLocation();
+		Params.LaunchVelocity = Hand.GetRotation().GetForwardVector() * ProjectileSpeed;
+		Params.ProjectileRadius = 5.f;
+		Params.TraceChannel = ECC_Visibility;
+		Params.bTraceComplex = true;
+
+		FPredictProjectilePathParams ReferenceParams(Params.ProjectileRadius, Params.StartLocation, Params.LaunchVelocity,
+			Params.MaxSimTime, Params.TraceChannel);
+		ReferenceParams.SimFrequency = Params.SimFrequency;
+		ReferenceParams.bTraceComplex = Params.bTraceComplex;
+		FPredictProjectilePathResult Reference;
+		const bool bReferenceHit = UGameplayStatics::PredictProjectilePath(World, ReferenceParams, Reference);
+
+		Broadphase.Invalidate();
+		Broadphase.Update(World, Params);
+		const FTeleportArcResult& Result = Broadphase.GetResult();
+		if (!Result.PathPoints.Num())
+		{
+			NumMismatches++;
+			AddError(FString::Printf(TEXT("Frame %d: no broadphase arc"), Frame));
+			continue;
+		}
+
+		const FVector& Destination = Result.PathPoints.Last();
+		const bool bSameHit = Result.bBlockingHit == bReferenceHit
+			&& (!bReferenceHit
+				|| (FVector::Dist(Result.HitResult.Location, Reference.HitResult.Location) <= LocationTolerance
+					&& Result.HitResult.ImpactNormal.Equals(Reference.HitResult.ImpactNormal, NormalTolerance)));
+		const bool bSameDestination = FVector::Dist(Destination, Reference.LastTraceDestination.Location) <= LocationTolerance;
+		if (!bSameHit || !bSameDestination)
+		{
+			NumMismatches++;
+			AddError(FString::Printf(TEXT("Frame %d: PredictProjectilePath %s at %s (normal %s, end %s), broadphase %s at %s (normal %s, end %s)"), Frame,
+				bReferenceHit ? TEXT("hit") : TEXT("missed"), *Reference.HitResult.Location.ToString(),
+				*Reference.HitResult.ImpactNormal.ToString(), *Reference.LastTraceDestination.Location.ToString(),
+				Result.bBlockingHit ? TEXT("hit") : TEXT("missed"), *Result.HitResult.Location.ToString(),
+				*Result.HitResult.ImpactNormal.ToString(), *Destination.ToString()));
+		}
+		NumHits += bReferenceHit ? 1 : 0;
+	}
+
+	// The floor is endless, so an arc that hits nothing means the world was not set up
+	TestEqual(TEXT("Arcs hitting the room"), NumHits, Session.GetNumFrames());
+	TestEqual(TEXT("Arcs differing from PredictProjectilePath"), NumMismatches, 0);
+
+	DestroyWorld(World);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRCharacterAimingAllocationTest, "ArchitectureExplorer.VRLocomotion.TeleportArc.CharacterAimingNoSteadyStateAllocations",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FVRCharacterAimingAllocationTest::RunTest(const FString& Parameters)
+{
+	const int32 WarmUpFrames = 10;
+
+	const FString SessionFilename = FPaths::ProjectContentDir() / TEXT("VRSessions/AimSweep.vrsession");
+	FVRSessionReplay Session;
+	if (!Session.Open(SessionFilename))
+	{
+		AddError(FString::Printf(TEXT("Could not open %s"), *SessionFilename));
+		return false;
+	}
+
+	// The character's own aiming path: arc prediction, the reachability field, the nav cache and the navigation
+	// system's projection, then drawing the arc. Every frame counts, whether or not it found a destination. The
+	// room has no nav mesh, so each projection is a miss; the benchmark test projects onto the main map's.
+	UWorld* World = CreateRoomWorld();
+	FNavigationSystem::AddNavigationSystemToWorld(*World, FNavigationSystemRunMode::GameMode);
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	AVRCharacter* Character = World->SpawnActor<AVRCharacter>(FVector(0.f, 0.f, 100.f), FRotator::ZeroRotator, SpawnParams);
+	Character->HandControllerBP = AHandController::StaticClass();
+	Character->SpawnHandControllers();
+	if (!TestTrue(TEXT("Character has both hands"), Character->LeftController && Character->RightController))
+	{
+		DestroyWorld(World);
+		return false;
+	}
+	Character->WarmUpLocomotion();
+
+	FCountingMalloc* CountingMalloc = nullptr;
+	uint64 StartAllocations = 0;
+	int32 NumHits = 0;
+	for (int32 Frame = 0; Frame < Session.GetNumFrames(); Frame++)
+	{
+		if (Frame == WarmUpFrames)
+		{
+			CountingMalloc = FCountingMalloc::Install();
+			StartAllocations = CountingMalloc->GetGameThreadAllocations();
+		}
+		Character->ApplyReplayFrame(Session.GetFrame(Frame), false);
+		FVector Destination;
+		if (Character->FindTeleportDestination(OUT Destination, OUT Character->TeleportPathPoints))
+		{
+			Character->DrawTeleportPath(Character->TeleportPathPoints);
+		}
+		else
+		{
+			Character->HideTeleportPath();
+		}
+		NumHits += Character->TeleportArcPredictor.GetResult().bBlockingHit ? 1 : 0;
+	}
+	const uint64 Allocations = CountingMalloc->GetGameThreadAllocations() - StartAllocations;
+	CountingMalloc->Uninstall();
+
+	TestTrue(TEXT("Arcs hit the room"), NumHits > 0);
+	TestEqual(*FString::Printf(TEXT("Game thread allocations over %d aiming frames"), Session.GetNumFrames() - WarmUpFrames), int64(Allocations), int64(0));
+
+	DestroyWorld(World);
+	return true;
+}
+
+#endif
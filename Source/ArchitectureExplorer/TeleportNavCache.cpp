@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TeleportNavCache.h"
+
+#include "ArchitectureExplorer.h"
+#include "NavMesh/RecastNavMesh.h"
+#include "NavigationSystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Teleport Nav Projection"), STAT_TeleportNavProjection, STATGROUP_VRLocomotion);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleport Nav Cache Hits"), STAT_TeleportNavCacheHits, STATGROUP_VRLocomotion);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleport Nav Cache Misses"), STAT_TeleportNavCacheMisses, STATGROUP_VRLocomotion);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleport Nav Cache Invalidations"), STAT_TeleportNavCacheInvalidations, STATGROUP_VRLocomotion);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleport Nav Cache Cells"), STAT_TeleportNavCacheCells, STATGROUP_VRLocomotion);
+
+bool FTeleportNavCache::ProjectPoint(UWorld* World, const FVector& Location, const FVector& QueryExtent, FVector& OutLocation)
+{
+	VR_LOCOMOTION_SCOPE(STAT_TeleportNavProjection, TeleportNavProjection);
+
+	const bool bUseCache = CellSize > 0.f;
+	if (bUseCache)
+	{
+		// Projections made with other settings don't carry over
+		if (CellsCellSize != CellSize || !CellsQueryExtent.Equals(QueryExtent))
+		{
+			Cells.Reset();
+			CellsCellSize = CellSize;
+			CellsQueryExtent = QueryExtent;
+		}
+
+		if (const FCachedProjection* Cached = Cells.Find(GetCell(Location)))
+		{
+			if (IsStillValid(World, *Cached))
+			{
+				++Hits;
+				INC_DWORD_STAT(STAT_TeleportNavCacheHits);
+				OutLocation = FVector(Location.X, Location.Y, Location.Z + Cached->HeightOffset);
+				return Cached->bOnNavMesh;
+			}
+		}
+	}
+
+	++Misses;
+	INC_DWORD_STAT(STAT_TeleportNavCacheMisses);
+
+	UNavigationSystemV1* NavSystem = UNavigationSystemV1::GetCurrent(World);
+	FNavLocation NavLocation;
+	const bool bOnNavMesh = NavSystem && NavSystem->ProjectPointToNavigation(Location, OUT NavLocation, QueryExtent);
+
+	if (bUseCache)
+	{
+		// A projection that moved sideways says nothing about the rest of the cell
+		const bool bVertical = !bOnNavMesh || FVector2D::DistSquared(FVector2D(NavLocation.Location), FVector2D(Location)) <= FMath::Square(MaxSidewaysProjection);
+		if (bVertical)
+		{
+			if (Cells.Num() >= MaxCells)
+			{
+				Cells.Reset();
+			}
+			Cells.Add(GetCell(Location), {NavLocation.NodeRef, bOnNavMesh ? NavLocation.Location.Z - Location.Z : 0.f, bOnNavMesh});
+		}
+		else
+		{
+			Cells.Remove(GetCell(Location));
+		}
+		SET_DWORD_STAT(STAT_TeleportNavCacheCells, Cells.Num());
+	}
+
+	OutLocation = NavLocation.Location;
+	return bOnNavMesh;
+}
+
+void FTeleportNavCache::Invalidate()
+{
+	++Invalidations;
+	INC_DWORD_STAT(STAT_TeleportNavCacheInvalidations);
+	Cells.Reset();
+	SET_DWORD_STAT(STAT_TeleportNavCacheCells, 0);
+}
+
+void FTeleportNavCache::Reserve()
+{
+	Cells.Reserve(MaxCells);
+}
+
+void FTeleportNavCache::OnNavMeshRebuilt()
+{
+	++Invalidations;
+	INC_DWORD_STAT(STAT_TeleportNavCacheInvalidations);
+	for (auto It = Cells.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().bOnNavMesh)
+		{
+			It.RemoveCurrent();
+		}
+	}
+	SET_DWORD_STAT(STAT_TeleportNavCacheCells, Cells.Num());
+}
+
+bool FTeleportNavCache::IsStillValid(UWorld* World, const FCachedProjection& Cached) const
+{
+	if (!Cached.bOnNavMesh)
+	{
+		return true;
+	}
+	// Rebuilding a tile changes its salt, so references to polygons of rebuilt tiles no longer resolve
+	UNavigationSystemV1* NavSystem = UNavigationSystemV1::GetCurrent(World);
+	const ARecastNavMesh* NavMesh = NavSystem ? Cast<ARecastNavMesh>(NavSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate)) : nullptr;
+	FVector PolyCenter;
+	return NavMesh && NavMesh->GetPolyCenter(Cached.Poly, OUT PolyCenter);
+}
+
+FIntVector FTeleportNavCache::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / CellSize));
+}
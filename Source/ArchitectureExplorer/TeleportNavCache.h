@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "AI/Navigation/NavigationTypes.h"
+#include "CoreMinimal.h"
+
+class UWorld;
+
+/**
+ * Caches nav mesh projections of teleport destinations on a grid, so aiming at the same floor area does not
+ * query Recast again. Hit locations are quantized to cells of CellSize, and a cell keeps what its first hit
+ * found out about the nav mesh rather than that hit's projected location: either that there is no nav mesh
+ * within the query extent, or that the nav mesh lies straight above or below the hit, at some height offset,
+ * on a given polygon. Later hits in the cell keep their own XY and get the same offset. Hits near nav mesh
+ * edges, whose projection moved sideways, are always projected. After a rebuild, cells on the nav mesh stay valid
+ * while their polygon still exists, which is only false inside rebuilt tiles; cells without nav mesh are
+ * dropped, since new nav mesh could have appeared anywhere.
+ */
+class FTeleportNavCache
+{
+public:
+	// Projects Location onto the nav mesh within QueryExtent. Returns false if it isn't on the nav mesh.
+	bool ProjectPoint(UWorld* World, const FVector& Location, const FVector& QueryExtent, FVector& OutLocation);
+
+	// Forgets every cached projection
+	void Invalidate();
+
+	// Allocates room for MaxCells up front. The cache never holds more, so caching doesn't allocate afterwards.
+	void Reserve();
+
+	// Forgets what can't be rechecked after nav mesh tiles were rebuilt, see the class comment
+	void OnNavMeshRebuilt();
+
+	uint64 GetHits() const { return Hits; }
+	uint64 GetMisses() const { return Misses; }
+	uint64 GetInvalidations() const { return Invalidations; }
+
+public: // tuning
+	// Grid cell edge in cm. Zero or less disables caching.
+	float CellSize = 25.f;
+
+	// The cache is cleared once it holds this many cells, which keeps it within what Reserve allocated
+	int32 MaxCells = 4096;
+
+	// Projections that moved a hit further sideways than this (cm) are not cached
+	float MaxSidewaysProjection = 1.f;
+
+private:
+	struct FCachedProjection
+	{
+		NavNodeRef Poly;
+		float HeightOffset;
+		bool bOnNavMesh;
+	};
+
+	FIntVector GetCell(const FVector& Location) const;
+	bool IsStillValid(UWorld* World, const FCachedProjection& Cached) const;
+
+	TMap<FIntVector, FCachedProjection> Cells;
+	FVector CellsQueryExtent = FVector::ZeroVector;
+	float CellsCellSize = 0.f;
+
+	uint64 Hits = 0;
+	uint64 Misses = 0;
+	uint64 Invalidations = 0;
+};
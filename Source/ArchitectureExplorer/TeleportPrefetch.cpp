@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TeleportPrefetch.h"
+
+#include "ArchitectureExplorer.h"
+#include "ContentStreaming.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/LevelStreamingVolume.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleport Prefetch Levels"), STAT_TeleportPrefetchLevels, STATGROUP_VRLocomotion);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleports Waited For Streaming"), STAT_TeleportsWaited, STATGROUP_VRLocomotion);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Teleports Timed Out Streaming"), STAT_TeleportsTimedOut, STATGROUP_VRLocomotion);
+
+void FTeleportPrefetch::Begin(UWorld* World, const FVector& Destination, float Duration)
+{
+	ReleaseLevels();
+	if (!World)
+	{
+		return;
+	}
+
+	for (TActorIterator<ALevelStreamingVolume> It(World); It; ++It)
+	{
+		ALevelStreamingVolume* Volume = *It;
+		if (Volume->bDisabled || !Volume->EncompassesPoint(Destination))
+		{
+			continue;
+		}
+		const bool bNeedsVisible = Volume->StreamingUsage != SVB_Loading && Volume->StreamingUsage != SVB_LoadingNotVisible;
+
+		for (ULevelStreaming* Level : World->GetStreamingLevels())
+		{
+			if (Level && Volume->StreamingLevelNames.Contains(Level->GetWorldAssetPackageFName()) && !IsPending(Level))
+			{
+				// Streaming volumes reset these flags from the current view every tick, so the levels are taken
+				// out of volume control until the player is inside the volume, which then keeps them loaded
+				PendingLevels.Add({Level, bNeedsVisible, Level->bDisableDistanceStreaming});
+				Level->bDisableDistanceStreaming = true;
+				Level->SetShouldBeLoaded(true);
+				Level->SetShouldBeVisible(Level->ShouldBeVisible() || bNeedsVisible);
+			}
+		}
+	}
+	SET_DWORD_STAT(STAT_TeleportPrefetchLevels, PendingLevels.Num());
+
+	// Streams texture (and mesh) mips as if a camera were already standing there
+	IStreamingManager::Get().AddViewSlaveLocation(Destination, TextureBoostFactor, false, Duration);
+}
+
+bool FTeleportPrefetch::IsPending(const ULevelStreaming* Level) const
+{
+	for (const FPendingLevel& Pending : PendingLevels)
+	{
+		if (Pending.Level.Get() == Level)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool FTeleportPrefetch::IsResident() const
+{
+	for (const FPendingLevel& Pending : PendingLevels)
+	{
+		const ULevelStreaming* Level = Pending.Level.Get();
+		if (Level && (!Level->IsLevelLoaded() || (Pending.bNeedsVisible && !Level->IsLevelVisible())))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FTeleportPrefetch::Finish(float WaitSeconds, bool bTimedOut)
+{
+	Teleports++;
+	if (WaitSeconds > 0.f)
+	{
+		WaitedTeleports++;
+		TotalWaitSeconds += WaitSeconds;
+		MaxWaitSeconds = FMath::Max(MaxWaitSeconds, WaitSeconds);
+		INC_DWORD_STAT(STAT_TeleportsWaited);
+	}
+	if (bTimedOut)
+	{
+		TimedOutTeleports++;
+		INC_DWORD_STAT(STAT_TeleportsTimedOut);
+	}
+	CSV_CUSTOM_STAT(VRLocomotion, TeleportStreamingWaitMs, WaitSeconds * 1000.f, ECsvCustomStatOp::Set);
+
+	UE_LOG(LogVRLocomotion, Verbose, TEXT("Teleport waited %.2f s for streaming%s. %u of %u teleports waited (max %.2f s, total %.2f s), %u timed out"),
+		WaitSeconds, bTimedOut ? TEXT(" and timed out") : TEXT(""), WaitedTeleports, Teleports, MaxWaitSeconds, TotalWaitSeconds, TimedOutTeleports);
+
+	ReleaseLevels();
+}
+
+void FTeleportPrefetch::ReleaseLevels()
+{
+	for (const FPendingLevel& Pending : PendingLevels)
+	{
+		if (ULevelStreaming* Level = Pending.Level.Get())
+		{
+			Level->bDisableDistanceStreaming = Pending.bWasDistanceStreamingDisabled;
+		}
+	}
+	PendingLevels.Reset();
+	SET_DWORD_STAT(STAT_TeleportPrefetchLevels, 0);
+}
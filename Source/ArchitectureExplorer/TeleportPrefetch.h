@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+class ULevelStreaming;
+class UWorld;
+
+/**
+ * Streams in the destination of a teleport while the view is faded out. Levels of every streaming volume that
+ * contains the destination are requested right away, and the texture streamer is told to treat the destination
+ * as a view location, so the teleport only has to wait for whatever hasn't arrived by the time the fade ends.
+ * Keeps count of how often, and for how long, teleports had to wait.
+ */
+class FTeleportPrefetch
+{
+public:
+	~FTeleportPrefetch() { ReleaseLevels(); }
+
+	// Requests the levels and textures around Destination, keeping textures boosted for Duration seconds
+	void Begin(UWorld* World, const FVector& Destination, float Duration);
+
+	// True once every level requested by Begin is loaded, and visible where the volume asks for it
+	bool IsResident() const;
+
+	// Records how long the teleport waited after its fade, and whether it gave up waiting. Hands the levels back
+	// to their streaming volumes.
+	void Finish(float WaitSeconds, bool bTimedOut);
+
+	int32 GetNumPendingLevels() const { return PendingLevels.Num(); }
+
+	uint32 GetTeleports() const { return Teleports; }
+	uint32 GetWaitedTeleports() const { return WaitedTeleports; }
+	uint32 GetTimedOutTeleports() const { return TimedOutTeleports; }
+	float GetMaxWaitSeconds() const { return MaxWaitSeconds; }
+	float GetTotalWaitSeconds() const { return TotalWaitSeconds; }
+
+public: // tuning
+	// Texture streaming boost for the destination view
+	float TextureBoostFactor = 1.f;
+
+private:
+	// Restores the streaming state the levels had before Begin
+	void ReleaseLevels();
+	bool IsPending(const ULevelStreaming* Level) const;
+
+	struct FPendingLevel
+	{
+		TWeakObjectPtr<ULevelStreaming> Level;
+		bool bNeedsVisible;
+		bool bWasDistanceStreamingDisabled;
+	};
+	TArray<FPendingLevel, TInlineAllocator<8>> PendingLevels;
+
+	uint32 Teleports = 0;
+	uint32 WaitedTeleports = 0;
+	uint32 TimedOutTeleports = 0;
+	float MaxWaitSeconds = 0.f;
+	float TotalWaitSeconds = 0.f;
+};
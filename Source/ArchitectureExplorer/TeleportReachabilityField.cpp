@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "TeleportReachabilityField.h"
+
+#include "ArchitectureExplorer.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "NavMesh/RecastNavMesh.h"
+#include "NavigationSystem.h"
+
+FTeleportReachabilityField::FTeleportReachabilityField()
+{
+	FMemory::Memzero(Header);
+}
+
+FTeleportReachabilityField::~FTeleportReachabilityField()
+{
+	Unload();
+}
+
+bool FTeleportReachabilityField::Load(const FString& Filename)
+{
+	Unload();
+
+	const uint8* Bytes = nullptr;
+	int64 NumBytes = 0;
+
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+	if (MappedFile)
+	{
+		MappedRegion.Reset(MappedFile->MapRegion());
+	}
+	if (MappedRegion)
+	{
+		Bytes = MappedRegion->GetMappedPtr();
+		NumBytes = MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		MappedFile.Reset();
+		if (!FPaths::FileExists(Filename) || !FFileHelper::LoadFileToArray(LoadedBytes, *Filename))
+		{
+			return false;
+		}
+		Bytes = LoadedBytes.GetData();
+		NumBytes = LoadedBytes.Num();
+	}
+
+	if (NumBytes < int64(sizeof(FHeader)))
+	{
+		UE_LOG(LogVRLocomotion, Warning, TEXT("Teleport reachability field %s is truncated"), *Filename);
+		Unload();
+		return false;
+	}
+
+	FMemory::Memcpy(&Header, Bytes, sizeof(FHeader));
+	const bool bValidHeader = Header.Magic == FileMagic && Header.Version == FileVersion && Header.CellSize > 0.f && Header.CellHeight > 0.f
+		&& Header.Dims.X > 0 && Header.Dims.Y > 0 && Header.Dims.Z > 0 && Header.Dims.Z <= MAX_uint16;
+	NumTiles = bValidHeader ? GetNumTiles(Header.Dims) : FIntPoint::ZeroValue;
+	const int64 TilesBytes = int64(NumTiles.X) * NumTiles.Y * sizeof(uint32);
+	const int64 ColumnsBytes = int64(Header.NumTiles) * TileColumns * sizeof(uint32);
+	const int64 LayersBytes = int64(Header.NumLayers) * sizeof(FLayer);
+	if (!bValidHeader || NumBytes < int64(sizeof(FHeader)) + TilesBytes + ColumnsBytes + LayersBytes)
+	{
+		UE_LOG(LogVRLocomotion, Warning, TEXT("Teleport reachability field %s is invalid or out of date"), *Filename);
+		Unload();
+		return false;
+	}
+
+	Tiles = reinterpret_cast<const uint32*>(Bytes + sizeof(FHeader));
+	Columns = reinterpret_cast<const uint32*>(Bytes + sizeof(FHeader) + TilesBytes);
+	Layers = reinterpret_cast<const FLayer*>(Bytes + sizeof(FHeader) + TilesBytes + ColumnsBytes);
+	return true;
+}
+
+void FTeleportReachabilityField::Unload()
+{
+	Tiles = nullptr;
+	Columns = nullptr;
+	Layers = nullptr;
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	LoadedBytes.Empty();
+}
+
+FTeleportReachabilityField::EReachability FTeleportReachabilityField::Query(const FVector& Location, const FVector& Extent, FVector& OutLocation) const
+{
+	if (!Tiles)
+	{
+		return EReachability::Unknown;
+	}
+
+	const FVector Local = Location - Header.Origin;
+	const int32 X = FMath::FloorToInt(Local.X / Header.CellSize);
+	const int32 Y = FMath::FloorToInt(Local.Y / Header.CellSize);
+	const int32 Z = FMath::FloorToInt(Local.Z / Header.CellHeight);
+	if (X < 0 || Y < 0 || Z < 0 || X >= Header.Dims.X || Y >= Header.Dims.Y || Z >= Header.Dims.Z)
+	{
+		return EReachability::Unknown;
+	}
+
+	// Same search as projecting onto the nav mesh with Extent: the nearest nav mesh cell within the box wins
+	const int32 MinX = FMath::Max(FMath::FloorToInt((Local.X - Extent.X) / Header.CellSize), 0);
+	const int32 MinY = FMath::Max(FMath::FloorToInt((Local.Y - Extent.Y) / Header.CellSize), 0);
+	const int32 MinZ = FMath::Max(FMath::FloorToInt((Local.Z - Extent.Z) / Header.CellHeight), 0);
+	const int32 MaxX = FMath::Min(FMath::FloorToInt((Local.X + Extent.X) / Header.CellSize), Header.Dims.X - 1);
+	const int32 MaxY = FMath::Min(FMath::FloorToInt((Local.Y + Extent.Y) / Header.CellSize), Header.Dims.Y - 1);
+	const int32 MaxZ = FMath::Min(FMath::FloorToInt((Local.Z + Extent.Z) / Header.CellHeight), Header.Dims.Z - 1);
+
+	float BestDistanceSquared = MAX_flt;
+	for (int32 CellY = MinY; CellY <= MaxY; CellY++)
+	{
+		for (int32 CellX = MinX; CellX <= MaxX; CellX++)
+		{
+			const uint32* Column = FindColumn(CellX, CellY);
+			if (!Column)
+			{
+				continue;
+			}
+			const uint32 EndLayer = FMath::Min(Column[1], Header.NumLayers);
+			for (uint32 Index = Column[0]; Index < EndLayer; Index++)
+			{
+				const FLayer& Layer = Layers[Index];
+				if (Layer.Z < MinZ)
+				{
+					continue;
+				}
+				if (Layer.Z > MaxZ)
+				{
+					break; // Layers are stored bottom up
+				}
+				const float CellBottom = Header.Origin.Z + Layer.Z * Header.CellHeight;
+				const FVector CellMin = Header.Origin + FVector(CellX * Header.CellSize, CellY * Header.CellSize, 0.f);
+				const FVector Candidate(
+					FMath::Clamp(Location.X, CellMin.X, CellMin.X + Header.CellSize),
+					FMath::Clamp(Location.Y, CellMin.Y, CellMin.Y + Header.CellSize),
+					CellBottom + (Layer.Height - 1) / 254.f * Header.CellHeight);
+				const float DistanceSquared = FVector::DistSquared(Candidate, Location);
+				if (FMath::Abs(Candidate.Z - Location.Z) <= Extent.Z && DistanceSquared < BestDistanceSquared)
+				{
+					BestDistanceSquared = DistanceSquared;
+					OutLocation = Candidate;
+				}
+			}
+		}
+	}
+	return BestDistanceSquared < MAX_flt ? EReachability::Reachable : EReachability::Unreachable;
+}
+
+const uint32* FTeleportReachabilityField::FindColumn(int32 X, int32 Y) const
+{
+	const uint32 Tile = Tiles[X / TileSize + NumTiles.X * (Y / TileSize)];
+	if (Tile == EmptyTile || Tile >= Header.NumTiles)
+	{
+		return nullptr;
+	}
+	return Columns + int64(Tile) * TileColumns + X % TileSize + TileSize * (Y % TileSize);
+}
+
+uint32 FTeleportReachabilityField::HashNavMesh(UWorld* World)
+{
+	UNavigationSystemV1* NavSystem = UNavigationSystemV1::GetCurrent(World);
+	const ARecastNavMesh* NavMesh = NavSystem ? Cast<ARecastNavMesh>(NavSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate)) : nullptr;
+	if (!NavMesh)
+	{
+		return 0;
+	}
+
+	// Tile salts change on every rebuild, so only the geometry is hashed: a rebuild that produces the same
+	// polygons keeps the field valid
+	uint32 Hash = 0;
+	TArray<FNavPoly> Polys;
+	for (int32 TileIndex = 0; TileIndex < NavMesh->GetNavMeshTilesCount(); TileIndex++)
+	{
+		Polys.Reset();
+		NavMesh->GetPolysInTile(TileIndex, OUT Polys);
+		for (const FNavPoly& Poly : Polys)
+		{
+			Hash = FCrc::MemCrc32(&Poly.Center, sizeof(Poly.Center), Hash);
+		}
+	}
+	return Hash;
+}
+
+uint8 FTeleportReachabilityField::EncodeCell(float NavHeight, float CellHeight)
+{
+	return uint8(1 + FMath::Clamp(FMath::RoundToInt(NavHeight / CellHeight * 254.f), 0, 254));
+}
+
+FString FTeleportReachabilityField::GetFilenameForLevel(const FString& LevelName)
+{
+	return FPaths::ProjectContentDir() / TEXT("TeleportReachability") / LevelName + TEXT(".reach");
+}
+
+FIntPoint FTeleportReachabilityField::GetNumTiles(const FIntVector& Dims)
+{
+	return FIntPoint(FMath::DivideAndRoundUp(Dims.X, TileSize), FMath::DivideAndRoundUp(Dims.Y, TileSize));
+}
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+class UWorld;
+
+/**
+ * Baked grid of which cells of a level hold nav mesh, so teleport destinations can be validated and snapped
+ * without querying the navigation system. Only cells with nav mesh are stored: the XY grid is split into tiles
+ * of TileSize x TileSize columns, tiles without nav mesh cost one index entry, and each column of the others
+ * lists its nav mesh layers (cell Z and the height of the nav mesh inside the cell), bottom up. A query is one
+ * tile lookup and a scan of the few layers of each column within the query extent. Files are written by the
+ * BakeTeleportReachability commandlet and memory mapped at runtime. They record a hash of the nav mesh they were
+ * sampled from, so a field can be dropped once the nav mesh has changed (see HashNavMesh).
+ */
+class FTeleportReachabilityField
+{
+public:
+	enum class EReachability : uint8
+	{
+		Unknown, // No field loaded, or the location is outside of it
+		Unreachable,
+		Reachable,
+	};
+
+	// On-disk header, followed by the tile index (one entry per tile, X fastest, EmptyTile when the tile has no
+	// nav mesh), NumTiles column tables (TileSize * TileSize + 1 first layer indices, X fastest, the last one
+	// ending the tile) and NumLayers layers
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		FVector Origin;
+		float CellSize;
+		float CellHeight;
+		FIntVector Dims;
+		uint32 NumTiles;
+		uint32 NumLayers;
+		uint32 NavMeshHash;
+	};
+
+	// A cell with nav mesh
+	struct FLayer
+	{
+		uint16 Z;
+		uint8 Height;
+		uint8 Reserved;
+	};
+
+	static const uint32 FileMagic = 0x48434552; // 'RECH'
+	static const uint32 FileVersion = 3;
+
+	static const int32 TileSize = 16;
+	static const int32 TileColumns = TileSize * TileSize + 1;
+	static const uint32 EmptyTile = MAX_uint32;
+
+	FTeleportReachabilityField();
+	~FTeleportReachabilityField();
+
+	bool Load(const FString& Filename);
+	void Unload();
+	bool IsLoaded() const { return Tiles != nullptr; }
+
+	// Looks for nav mesh within Extent of Location, like projecting it onto the nav mesh would. When reachable,
+	// OutLocation is the nearest point of the nearest cell with nav mesh, at the nav mesh height.
+	EReachability Query(const FVector& Location, const FVector& Extent, FVector& OutLocation) const;
+
+	// Hash of the nav mesh the field was sampled from
+	uint32 GetNavMeshHash() const { return Header.NavMeshHash; }
+
+	// Cell byte for a nav mesh found at NavHeight above the bottom of a cell of CellHeight
+	static uint8 EncodeCell(float NavHeight, float CellHeight);
+
+	static FString GetFilenameForLevel(const FString& LevelName);
+
+	// Tiles along X and Y covering Dims
+	static FIntPoint GetNumTiles(const FIntVector& Dims);
+
+	// Hash of the polygons of World's default nav mesh, 0 without one
+	static uint32 HashNavMesh(UWorld* World);
+
+private:
+	// First and end layer indices of a column, or null when its tile has no nav mesh
+	const uint32* FindColumn(int32 X, int32 Y) const;
+
+	FHeader Header;
+	FIntPoint NumTiles = FIntPoint::ZeroValue;
+	const uint32* Tiles = nullptr;
+	const uint32* Columns = nullptr;
+	const FLayer* Layers = nullptr;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	// Used where the platform can't memory map files
+	TArray<uint8> LoadedBytes;
+};
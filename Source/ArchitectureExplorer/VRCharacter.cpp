@@ -2,18 +2,61 @@
 
 #include "VRCharacter.h"
 
+#include "ArchitectureExplorer.h"
 #include "Components/CapsuleComponent.h"
+#include "Engine/Engine.h"
 #include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "IXRTrackingSystem.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
 #include "Kismet/GameplayStatics.h"
 #include "NavigationSystem.h"
+#include "Net/UnrealNetwork.h"
 #include "TimerManager.h"
-#define OUT
+
+DECLARE_CYCLE_STAT(TEXT("VR Root Correction and Climb"), STAT_VRRootCorrection, STATGROUP_VRLocomotion);
+DECLARE_CYCLE_STAT(TEXT("Teleport Destination"), STAT_TeleportDestination, STATGROUP_VRLocomotion);
+DECLARE_CYCLE_STAT(TEXT("Blinker Update"), STAT_BlinkerUpdate, STATGROUP_VRLocomotion);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Climbing Hands"), STAT_ClimbingHands, STATGROUP_VRLocomotion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("VR Pose Updates Sent"), STAT_VRPoseUpdatesSent, STATGROUP_VRLocomotion);
+
+namespace
+{
+	IConsoleVariable* GetPixelDensityCVar()
+	{
+		static IConsoleVariable* PixelDensity = IConsoleManager::Get().FindConsoleVariable(TEXT("vr.PixelDensity"));
+		return PixelDensity;
+	}
+
+	// vr.PixelDensity for writing by code, or null while a higher priority setter (the console) owns it
+	IConsoleVariable* GetWritablePixelDensityCVar()
+	{
+		IConsoleVariable* PixelDensity = GetPixelDensityCVar();
+		if (PixelDensity && (PixelDensity->GetFlags() & ECVF_SetByMask) > ECVF_SetByCode)
+		{
+			UE_LOG(LogVRLocomotion, Verbose, TEXT("vr.PixelDensity was set with a higher priority than code, leaving it at %f"), PixelDensity->GetFloat());
+			return nullptr;
+		}
+		return PixelDensity;
+	}
+}
 
 // Sets default values
-AVRCharacter::AVRCharacter()
+AVRCharacter::AVRCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UVRMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// This one tick drives all of locomotion, including climbing for both hands.
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	VRMovement = Cast<UVRMovementComponent>(GetCharacterMovement());
 
 	VRRoot = CreateDefaultSubobject<USceneComponent>(TEXT("VRRoot"));
 	VRRoot->SetupAttachment(GetRootComponent());
@@ -21,14 +64,54 @@ AVRCharacter::AVRCharacter()
 	Camera = CreateDefaultSubobject<UCameraComponent>(TEXT("Camera"));
 	Camera->SetupAttachment(VRRoot);
 
-	TeleportPath = CreateDefaultSubobject<USplineComponent>(TEXT("TeleportPath"));
-	TeleportPath->SetupAttachment(VRRoot);
+	TeleportArc = CreateDefaultSubobject<UTeleportArcComponent>(TEXT("TeleportArc"));
+	TeleportArc->SetupAttachment(VRRoot);
 
 	DestinationMarker = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("DestinationMarker"));
 	DestinationMarker->SetupAttachment(GetRootComponent());
 
 	PostProcessComponent = CreateDefaultSubobject<UPostProcessComponent>(TEXT("PostProcessComponent"));
 	PostProcessComponent->SetupAttachment(GetRootComponent());
+
+	// Reviewers only need to see each other within the building
+	NetCullDistanceSquared = FMath::Square(5000.f);
+	// Scaled down from NearNetUpdateFrequency with distance to the nearest viewer, see UpdateNetUpdateFrequency
+	NetUpdateFrequency = NearNetUpdateFrequency;
+	MinNetUpdateFrequency = 5.f;
+
+	// Room scale, climbing and teleports move the capsule outside of the movement component, so the owning
+	// client's position is authoritative (together with ClientAuthorativePosition in DefaultGame.ini)
+	GetCharacterMovement()->bIgnoreClientMovementErrorChecksAndCorrection = true;
+}
+
+void AVRCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(AVRCharacter, ReplicatedPose, COND_SkipOwner);
+	DOREPLIFETIME_CONDITION(AVRCharacter, LastTeleport, COND_SimulatedOnly);
+}
+
+float AVRCharacter::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	const float Priority = Super::GetNetPriority(ViewPos, ViewDir, Viewer, ViewTarget, InChannel, Time, bLowBandwidth);
+
+	// Nearby reviewers are sent first. Far ones fall back to a fraction of the update rate once bandwidth runs short.
+	const float Distance = FVector::Dist(ViewPos, GetActorLocation());
+	return Priority * FMath::Clamp(NetPriorityNearDistance / FMath::Max(Distance, 1.f), NetPriorityMinScale, 1.f);
+}
+
+void AVRCharacter::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// Hands are spawned while the level loads rather than when play begins
+	if (GetWorld() && GetWorld()->IsGameWorld())
+	{
+		const double StartSeconds = FPlatformTime::Seconds();
+		SpawnHandControllers();
+		StartupReport.AddWarmUpStep(TEXT("hands"), FPlatformTime::Seconds() - StartSeconds);
+	}
 }
 
 // Called when the game starts or when spawned
@@ -38,15 +121,103 @@ void AVRCharacter::BeginPlay()
 
 	DestinationMarker->SetVisibility(false); // Make sure teleport cylinder doesn't show at start
 
+	if (bLateLocomotionUpdate)
+	{
+		// After the motion controllers and all physics movement, right before the camera is updated for rendering
+		SetTickGroup(TG_PostPhysics);
+	}
+
+	TeleportArcPredictor.LocationTolerance = TeleportPredictionLocationTolerance;
+	TeleportArcPredictor.DirectionToleranceDegrees = TeleportPredictionAngleTolerance;
+	TeleportArcPredictor.SpeedTolerance = TeleportPredictionSpeedTolerance;
+	TeleportArcPredictor.MaxResultAge = TeleportPredictionMaxAge;
+	TeleportArcPredictor.FrameBudgetMs = TeleportPredictionBudgetMs;
+	TeleportArcPredictor.bAsyncTraces = bAsyncTeleportTraces;
+	TeleportArcPredictor.bBroadphase = bTeleportArcBroadphase;
+
+	TeleportNavCache.CellSize = TeleportNavCacheCellSize;
+	HapticsDispatcher.MinIntervalSeconds = HapticsMinInterval;
+	ClimbSolver.SmoothingSpeed = ClimbSmoothingSpeed;
+	LoadTeleportReachability();
+	if (bUseTeleportProxies)
+	{
+		TArray<AActor*> ProxyActors;
+		UGameplayStatics::GetAllActorsWithTag(this, TeleportProxyTag, OUT ProxyActors);
+		bTraceTeleportProxies = ProxyActors.Num() > 0;
+	}
+	if (UNavigationSystemV1* NavSystem = UNavigationSystemV1::GetCurrent(GetWorld()))
+	{
+		NavSystem->OnNavigationGenerationFinishedDelegate.AddDynamic(this, &AVRCharacter::OnNavigationGenerationFinished);
+	}
+
+	WarmUpLocomotion();
+
 	if (BlinkerMaterialBase)
 	{
 		BlinkerDynamicMaterial = UMaterialInstanceDynamic::Create(BlinkerMaterialBase, NULL);
 		PostProcessComponent->AddOrUpdateBlendable(BlinkerDynamicMaterial);
-		// BlinkerDynamicMaterial->SetScalarParameterValue(TEXT("Radius"), 0.4f);
-		BlinkerDynamicMaterial->SetScalarParameterValue(TEXT("Radius"), 2.0f); //disabled blinker
+		// Without a curve the blinker keeps its default radius, which is off screen
+		Blinker.Initialize(BlinkerDynamicMaterial, bBlinkerEnabled ? RadiusVsVelocity : nullptr, Camera);
 	}
 
-	if (HandControllerBP)
+	if (IConsoleVariable* PixelDensity = GetPixelDensityCVar())
+	{
+		BasePixelDensity = PixelDensity->GetFloat();
+	}
+
+	if (IsLocalVRUser())
+	{
+		FString ReplayFilename;
+		if (FParse::Value(FCommandLine::Get(), TEXT("ReplayVRSession="), ReplayFilename))
+		{
+			if (SessionReplay.Open(ReplayFilename))
+			{
+				BeginReplayTiming();
+			}
+		}
+		else if (bRecordSession || FParse::Param(FCommandLine::Get(), TEXT("RecordVRSession")))
+		{
+			SessionRecorder.Start(FVRSessionRecorder::MakeFilename());
+		}
+	}
+
+	if (bStartupReport)
+	{
+		StartupReport.Begin(TeleportTargetFrameRate > 0.f ? 1.f / TeleportTargetFrameRate : 0.f);
+	}
+}
+
+void AVRCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	SessionRecorder.Stop();
+	SessionReplay.Close();
+	EndReplayTiming();
+
+	// Hand the user's own resolution back
+	IConsoleVariable* PixelDensity = LocomotionResolution.GetScale() != 1.f ? GetWritablePixelDensityCVar() : nullptr;
+	if (PixelDensity)
+	{
+		PixelDensity->Set(BasePixelDensity, ECVF_SetByCode);
+	}
+
+	// The hands are spawned by every character on every machine, so they go with it, including when a remote
+	// character is culled by relevancy
+	for (AHandController* Hand : { LeftController, RightController })
+	{
+		if (Hand)
+		{
+			Hand->Destroy();
+		}
+	}
+	LeftController = nullptr;
+	RightController = nullptr;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AVRCharacter::SpawnHandControllers()
+{
+	if (HandControllerBP && !LeftController && !RightController)
 	{
 		LeftController = GetWorld()->SpawnActor<AHandController>(HandControllerBP);
 		if (LeftController)
@@ -63,63 +234,456 @@ void AVRCharacter::BeginPlay()
 			RightController->SetHand(EControllerHand::Right);
 			RightController->SetOwner(this);
 		}
+		if (!LeftController || !RightController)
+		{
+			return;
+		}
 		// Right controller pairing handled within this method.
-		LeftController->PairController(RightController);
+		LeftController->SetOwningCharacter(this);
+		RightController->SetOwningCharacter(this);
+
+		// Tick after the motion controllers have picked up this frame's hand poses
+		AddTickPrerequisiteComponent(LeftController->GetMotionController());
+		AddTickPrerequisiteComponent(RightController->GetMotionController());
 	}
 }
 
+// Sizes every buffer of the teleport path pipeline and creates every arc segment up front, so neither aiming
+// nor the first long arc allocates or registers anything. Quality starts at the full tier, which has the longest arcs.
+void AVRCharacter::WarmUpLocomotion()
+{
+	double StepStartSeconds = FPlatformTime::Seconds();
+	const FTeleportArcParams ArcParams = MakeTeleportArcParams();
+	const int32 MaxPathPoints = FTeleportArcPredictor::GetMaxPathPoints(ArcParams);
+	TeleportArcPredictor.Reserve(ArcParams);
+	TeleportPathPoints.Reserve(MaxPathPoints);
+	StartupReport.AddWarmUpStep(TEXT("path buffers"), FPlatformTime::Seconds() - StepStartSeconds);
+
+	StepStartSeconds = FPlatformTime::Seconds();
+	TeleportArc->SetStaticMesh(TeleportArcMesh);
+	TeleportArc->SetMaterial(0, TeleportArcMaterial);
+	TeleportArc->ReserveSegments(MaxPathPoints - 1);
+	TeleportArc->SetVisibility(false);
+	StartupReport.AddWarmUpStep(TEXT("arc segments"), FPlatformTime::Seconds() - StepStartSeconds);
+
+	StepStartSeconds = FPlatformTime::Seconds();
+	TeleportNavCache.Reserve();
+	StartupReport.AddWarmUpStep(TEXT("nav cache"), FPlatformTime::Seconds() - StepStartSeconds);
+}
+
 // Called every frame
 void AVRCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
-	UpdateCharacterVRRootLocation();
+
+	if (HasAuthority() && GetNetMode() != NM_Standalone)
+	{
+		UpdateNetUpdateFrequency();
+	}
+
+	const bool bLocalUser = IsLocalVRUser();
+	if (!bLocalUserStateApplied || bLocalUser != bAppliedLocalUser)
+	{
+		ApplyLocalUserState(bLocalUser);
+	}
+	if (!bLocalUser)
+	{
+		// Other players' characters only mirror what their own machines replicate
+		ApplyRemotePose(DeltaTime);
+		return;
+	}
+
+	// This frame's input has been handled by now, and the poses are what locomotion is about to use
+	if (SessionReplay.IsOpen())
+	{
+		if (ReplayFrame < SessionReplay.GetNumFrames())
+		{
+			const FVRRecordedFrame& Frame = SessionReplay.GetFrame(ReplayFrame++);
+			ApplyReplayFrame(Frame, true);
+			AdvanceReplayTiming(Frame.DeltaTime);
+		}
+		else
+		{
+			UE_LOG(LogVRLocomotion, Display, TEXT("VR session replay finished after %d frames"), ReplayFrame);
+			SessionReplay.Close();
+			EndReplayTiming();
+			// Hand head and hands back to the HMD and controllers next frame
+			bLocalUserStateApplied = false;
+		}
+	}
+	else if (SessionRecorder.IsRecording())
+	{
+		RecordSessionFrame(DeltaTime);
+	}
+
+	const uint64 LocomotionStartCycles = StartupReport.IsRunning() ? FPlatformTime::Cycles64() : 0;
+
+	// Climbing and root correction are applied together as one move
+	UpdateCharacterVRRootLocation(DeltaTime);
+
+	if (bAdaptiveTeleportQuality && TeleportTargetFrameRate > 0.f)
+	{
+		TeleportArcQuality.Update(FTeleportArcQuality::GetFrameWorkSeconds(), 1.f / TeleportTargetFrameRate);
+	}
 	UpdateDestinationMarker();
 
 	UpdateBlinker();
+
+	if (bLocomotionResolution)
+	{
+		UpdateLocomotionResolution(DeltaTime);
+	}
+
+	SendLocalPose();
+
+	// Rumble requested by the hands since the last tick, at most one effect per hand
+	HapticsDispatcher.Flush(GetWorld()->GetTimeSeconds());
+
+	if (StartupReport.IsRunning())
+	{
+		StartupReport.AddTick(DeltaTime, FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - LocomotionStartCycles));
+	}
 }
 
-void AVRCharacter::UpdateBlinker()
+void AVRCharacter::PawnClientRestart()
+{
+	Super::PawnClientRestart();
+
+	// Only the machine that owns the controllers plays their rumble
+	HapticsDispatcher.SetPlayerController(Cast<APlayerController>(GetController()));
+}
+
+void AVRCharacter::UnPossessed()
 {
-	float PlayerSpeedMeters = GetVelocity().Size() / 100;
-	// UE_LOG(LogTemp, Display, TEXT("Player speed %f"), PlayerSpeedMeters);
+	Super::UnPossessed();
 
-	//disabled blinker
-	// float BlinkerRadius = RadiusVsVelocity->GetFloatValue(PlayerSpeedMeters);
-	// BlinkerDynamicMaterial->SetScalarParameterValue(TEXT("Radius"), BlinkerRadius);
+	HapticsDispatcher.SetPlayerController(nullptr);
+}
 
-	// FVector2D Center = GetBlinkerCenter();
-	// BlinkerDynamicMaterial->SetVectorParameterValue(TEXT("Center"), FLinearColor(Center.X, Center.Y, 0));
+bool AVRCharacter::IsLocalVRUser() const
+{
+	return GetNetMode() == NM_Standalone || IsLocallyControlled();
 }
 
-FVector2D AVRCharacter::GetBlinkerCenter()
+void AVRCharacter::ApplyLocalUserState(bool bLocalUser)
 {
-	FVector MovementDirection = GetVelocity().GetSafeNormal();
-	if (MovementDirection.IsNearlyZero())
+	bLocalUserStateApplied = true;
+	bAppliedLocalUser = bLocalUser;
+
+	// A replay stands in for the HMD and controllers
+	const bool bTracked = bLocalUser && !SessionReplay.IsOpen();
+	Camera->bLockToHmd = bTracked;
+
+	// The blinker is unbound and would darken the local view for every character in range
+	PostProcessComponent->bEnabled = bLocalUser;
+
+	if (LeftController && RightController)
 	{
-		return FVector2D(0.5, 0.5);
+		LeftController->SetTrackingEnabled(bTracked);
+		RightController->SetTrackingEnabled(bTracked);
 	}
-	FVector WorldStationaryLocation;
-	if (FVector::DotProduct(Camera->GetForwardVector(), MovementDirection) > 0)
+
+	if (!bLocalUser)
 	{
-		WorldStationaryLocation = Camera->GetComponentLocation() + MovementDirection * 1000;
+		DestinationMarker->SetVisibility(false);
+		HideTeleportPath();
 	}
-	else
+}
+
+FVRNetPose AVRCharacter::MakeLocalPose() const
+{
+	const FTransform& ActorTransform = GetActorTransform();
+	FVRNetPose Pose;
+	Pose.HeadLocation = ActorTransform.InverseTransformPosition(Camera->GetComponentLocation());
+	Pose.HeadRotation = FVRNetPose::PackRotation(ActorTransform.InverseTransformRotation(Camera->GetComponentQuat()).Rotator());
+
+	if (LeftController && RightController)
 	{
-		WorldStationaryLocation = Camera->GetComponentLocation() - MovementDirection * 1000;
+		Pose.LeftHandLocation = ActorTransform.InverseTransformPosition(LeftController->GetActorLocation());
+		Pose.LeftHandRotation = FVRNetPose::PackRotation(ActorTransform.InverseTransformRotation(LeftController->GetActorQuat()).Rotator());
+		Pose.RightHandLocation = ActorTransform.InverseTransformPosition(RightController->GetActorLocation());
+		Pose.RightHandRotation = FVRNetPose::PackRotation(ActorTransform.InverseTransformRotation(RightController->GetActorQuat()).Rotator());
+
+		EVRClimbFlags ClimbFlags = EVRClimbFlags::None;
+		if (LeftController->IsClimbing())
+		{
+			ClimbFlags |= EVRClimbFlags::LeftHand;
+		}
+		if (RightController->IsClimbing())
+		{
+			ClimbFlags |= EVRClimbFlags::RightHand;
+		}
+		Pose.ClimbFlags = uint8(ClimbFlags);
 	}
-	int32 SizeX;
-	int32 SizeY;
-	APlayerController* PlayerController = Cast<APlayerController>(GetController());
-	if (!PlayerController)
+	return Pose;
+}
+
+void AVRCharacter::SendLocalPose()
+{
+	if (GetNetMode() == NM_Standalone)
 	{
-		return FVector2D(0.5, 0.5);
+		return;
+	}
+
+	const FVRNetPose Pose = MakeLocalPose();
+	if (HasAuthority())
+	{
+		// Listen server host, property replication takes it from here
+		ReplicatedPose = Pose;
+		return;
+	}
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	if (Now - LastPoseSendTime < 1.f / FMath::Max(PoseSendRate, 1.f) || Pose.Equals(LastSentPose, PoseSendTolerance))
+	{
+		return;
+	}
+	ServerUpdatePose(Pose);
+	LastSentPose = Pose;
+	LastPoseSendTime = Now;
+	INC_DWORD_STAT(STAT_VRPoseUpdatesSent);
+	CSV_CUSTOM_STAT(VRLocomotion, PoseUpdatesSent, 1, ECsvCustomStatOp::Accumulate);
+}
+
+void AVRCharacter::UpdateNetUpdateFrequency()
+{
+	const float Now = GetWorld()->GetTimeSeconds();
+	if (Now < NextNetUpdateFrequencyTime)
+	{
+		return;
+	}
+	NextNetUpdateFrequencyTime = Now + NetUpdateFrequencyInterval;
+
+	// The update rate is per actor rather than per viewer, so it follows the nearest other player's view
+	float NearestDistanceSquared = MAX_flt;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* Viewer = It->Get();
+		if (!Viewer || Viewer == GetController())
+		{
+			continue;
+		}
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		Viewer->GetPlayerViewPoint(OUT ViewLocation, OUT ViewRotation);
+		NearestDistanceSquared = FMath::Min(NearestDistanceSquared, FVector::DistSquared(ViewLocation, GetActorLocation()));
+	}
+
+	const float Scale = NearestDistanceSquared < MAX_flt ? FMath::Min(NetPriorityNearDistance / FMath::Max(FMath::Sqrt(NearestDistanceSquared), 1.f), 1.f) : 0.f;
+	NetUpdateFrequency = FMath::Max(NearNetUpdateFrequency * Scale, MinNetUpdateFrequency);
+}
+
+bool AVRCharacter::ServerUpdatePose_Validate(const FVRNetPose& Pose)
+{
+	// Failing validation disconnects the client, which a tracking glitch or a teleport racing the pose must not do
+	return true;
+}
+
+void AVRCharacter::ServerUpdatePose_Implementation(const FVRNetPose& Pose)
+{
+	// Tracked devices stay within the play area around the character. A pose outside of it is dropped and the
+	// last good one stays until the next update.
+	if (Pose.HeadLocation.SizeSquared() >= FMath::Square(MaxPoseDistance)
+		|| Pose.LeftHandLocation.SizeSquared() >= FMath::Square(MaxPoseDistance)
+		|| Pose.RightHandLocation.SizeSquared() >= FMath::Square(MaxPoseDistance))
+	{
+		UE_LOG(LogVRLocomotion, Verbose, TEXT("Dropped a pose of %s outside of %.0f cm"), *GetName(), MaxPoseDistance);
+		return;
+	}
+	ReplicatedPose = Pose;
+}
+
+void AVRCharacter::ApplyRemotePose(float DeltaTime)
+{
+	const FTransform& ActorTransform = GetActorTransform();
+	const float Alpha = FMath::Clamp(DeltaTime * RemotePoseInterpSpeed, 0.f, 1.f);
+
+	// Eases each device towards its last replicated pose, which arrives at most PoseSendRate times a second
+	auto Follow = [&ActorTransform, Alpha](USceneComponent* Component, const FVector& Location, uint32 Rotation)
+	{
+		const FVector TargetLocation = ActorTransform.TransformPosition(Location);
+		const FQuat TargetRotation = ActorTransform.TransformRotation(FVRNetPose::UnpackRotation(Rotation).Quaternion());
+		Component->SetWorldLocationAndRotation(
+			FMath::Lerp(Component->GetComponentLocation(), TargetLocation, Alpha),
+			FQuat::Slerp(Component->GetComponentQuat(), TargetRotation, Alpha));
+	};
+
+	Follow(Camera, ReplicatedPose.HeadLocation, ReplicatedPose.HeadRotation);
+	if (LeftController && RightController)
+	{
+		Follow(LeftController->GetMotionController(), ReplicatedPose.LeftHandLocation, ReplicatedPose.LeftHandRotation);
+		Follow(RightController->GetMotionController(), ReplicatedPose.RightHandLocation, ReplicatedPose.RightHandRotation);
+
+		const EVRClimbFlags ClimbFlags = EVRClimbFlags(ReplicatedPose.ClimbFlags);
+		LeftController->SetRemoteClimbing(EnumHasAnyFlags(ClimbFlags, EVRClimbFlags::LeftHand));
+		RightController->SetRemoteClimbing(EnumHasAnyFlags(ClimbFlags, EVRClimbFlags::RightHand));
+	}
+}
+
+void AVRCharacter::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	// Rebuilt tiles may have moved or removed cached projections
+	TeleportNavCache.OnNavMeshRebuilt();
+	ProjectedArcSerial = 0;
+	LoadTeleportReachability();
+}
+
+void AVRCharacter::LoadTeleportReachability()
+{
+	if (!bUseTeleportReachabilityField)
+	{
+		return;
+	}
+
+	const FString LevelName = UWorld::RemovePIEPrefix(GetWorld()->GetMapName());
+	if (!TeleportReachability.Load(FTeleportReachabilityField::GetFilenameForLevel(LevelName)))
+	{
+		return;
+	}
+	// A field sampled from another nav mesh would accept and reject the wrong destinations. Without it,
+	// destinations are projected onto the nav mesh.
+	if (TeleportReachability.GetNavMeshHash() != FTeleportReachabilityField::HashNavMesh(GetWorld()))
+	{
+		UE_LOG(LogVRLocomotion, Warning, TEXT("Teleport reachability field for %s is stale, rebake it with -run=BakeTeleportReachability"), *LevelName);
+		TeleportReachability.Unload();
+	}
+}
+
+void AVRCharacter::RecordSessionFrame(float DeltaTime)
+{
+	if (LeftController && RightController)
+	{
+		SessionRecorder.WriteFrame(DeltaTime, Camera->GetRelativeTransform(),
+			LeftController->GetMotionController()->GetRelativeTransform(), RightController->GetMotionController()->GetRelativeTransform());
+	}
+}
+
+// Poses go where the HMD and motion controllers would put them, and input through the same handlers the
+// input component calls
+void AVRCharacter::BeginReplayTiming()
+{
+	bReplayTimed = true;
+	bReplayPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	ReplayPreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	ReplayNextFrameTime = FPlatformTime::Seconds();
+
+	// Play began within a frame whose delta time is already set, so the first recorded frame may still run at it
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(SessionReplay.GetNumFrames() > 0 ? SessionReplay.GetFrame(0).DeltaTime : ReplayPreviousFixedDeltaTime);
+}
+
+void AVRCharacter::AdvanceReplayTiming(float FrameDeltaTime)
+{
+	if (!bReplayTimed)
+	{
+		return;
+	}
+
+	// The engine picks the next frame's delta time before anything ticks, so set it up one frame ahead
+	if (ReplayFrame < SessionReplay.GetNumFrames())
+	{
+		FApp::SetFixedDeltaTime(SessionReplay.GetFrame(ReplayFrame).DeltaTime);
+	}
+
+	// A fixed time step doesn't throttle the engine. Wait out the rest of the recorded frame, so replays
+	// send poses and input at the pace they were recorded at; a frame that ran late doesn't rush the next.
+	const double Now = FPlatformTime::Seconds();
+	ReplayNextFrameTime = FMath::Max(ReplayNextFrameTime + FrameDeltaTime, Now);
+	if (ReplayNextFrameTime > Now)
+	{
+		FPlatformProcess::Sleep(float(ReplayNextFrameTime - Now));
+	}
+}
+
+void AVRCharacter::EndReplayTiming()
+{
+	if (!bReplayTimed)
+	{
+		return;
+	}
+	bReplayTimed = false;
+	FApp::SetUseFixedTimeStep(bReplayPreviousUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(ReplayPreviousFixedDeltaTime);
+}
+
+void AVRCharacter::ApplyReplayFrame(const FVRRecordedFrame& Frame, bool bApplyInput)
+{
+	const FTransform Head = Frame.GetHead();
+	Camera->SetRelativeLocationAndRotation(Head.GetLocation(), Head.GetRotation());
+	if (LeftController && RightController)
+	{
+		const FTransform LeftHand = Frame.GetLeftHand();
+		const FTransform RightHand = Frame.GetRightHand();
+		LeftController->GetMotionController()->SetRelativeLocationAndRotation(LeftHand.GetLocation(), LeftHand.GetRotation());
+		RightController->GetMotionController()->SetRelativeLocationAndRotation(RightHand.GetLocation(), RightHand.GetRotation());
+	}
+
+	if (!bApplyInput)
+	{
+		return;
+	}
+	MoveForward(FVRRecordedFrame::DequantizeAxis(Frame.MoveForward));
+	MoveRight(FVRRecordedFrame::DequantizeAxis(Frame.MoveRight));
+	if (EnumHasAnyFlags(Frame.Events, EVRInputEvents::GripLeft))
+	{
+		GripLeft();
+	}
+	if (EnumHasAnyFlags(Frame.Events, EVRInputEvents::ReleaseLeft))
+	{
+		ReleaseLeft();
+	}
+	if (EnumHasAnyFlags(Frame.Events, EVRInputEvents::GripRight))
+	{
+		GripRight();
+	}
+	if (EnumHasAnyFlags(Frame.Events, EVRInputEvents::ReleaseRight))
+	{
+		ReleaseRight();
+	}
+	if (EnumHasAnyFlags(Frame.Events, EVRInputEvents::Teleport))
+	{
+		BeginTeleport();
+	}
+}
+
+void AVRCharacter::UpdateLocomotionResolution(float DeltaTime)
+{
+	ELocomotionActivity Activity = ELocomotionActivity::None;
+	if (DestinationMarker->IsVisible())
+	{
+		Activity |= ELocomotionActivity::Aiming;
+	}
+	if (bTeleportPending)
+	{
+		Activity |= ELocomotionActivity::Teleporting;
+	}
+	if (ClimbSolver.IsClimbing())
+	{
+		Activity |= ELocomotionActivity::Climbing;
+	}
+	else if (GetVelocity().SizeSquared() > FMath::Square(LocomotionResolutionMovingSpeed))
+	{
+		Activity |= ELocomotionActivity::Moving;
+	}
+
+	if (!LocomotionResolution.Update(Activity, DeltaTime))
+	{
+		return;
+	}
+	if (IConsoleVariable* PixelDensity = GetWritablePixelDensityCVar())
+	{
+		PixelDensity->Set(BasePixelDensity * LocomotionResolution.GetScale(), ECVF_SetByCode);
+	}
+}
+
+void AVRCharacter::UpdateBlinker()
+{
+	VR_LOCOMOTION_SCOPE(STAT_BlinkerUpdate, BlinkerUpdate);
+
+	if (bBlinkerEnabled)
+	{
+		Blinker.Update(Camera->GetComponentQuat(), GetVelocity());
 	}
-	PlayerController->GetViewportSize(OUT SizeX, OUT SizeY); // Get screen dimensions in pixels
-	FVector2D ScreenLocation;
-	PlayerController->ProjectWorldLocationToScreen(WorldStationaryLocation, OUT ScreenLocation);
-	// UE_LOG(LogTemp, Display, TEXT("Screen location: %s"), *ScreenLocation.ToString())
-	// Normalize to U,V instead of pixels
-	return FVector2D(ScreenLocation.X / SizeX, ScreenLocation.Y / SizeY);
 }
 
 // Called to bind functionality to &AVR
@@ -140,6 +704,7 @@ void AVRCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCompone
 
 void AVRCharacter::MoveForward(float Throttle)
 {
+	SessionRecorder.SetMoveForward(Throttle);
 	if (FMath::Abs(Throttle) > 0.1)
 	{
 		AddMovementInput(Throttle * Camera->GetForwardVector());
@@ -148,6 +713,7 @@ void AVRCharacter::MoveForward(float Throttle)
 
 void AVRCharacter::MoveRight(float Throttle)
 {
+	SessionRecorder.SetMoveRight(Throttle);
 	if (FMath::Abs(Throttle) > 0.1)
 	{
 		AddMovementInput(Throttle * Camera->GetRightVector());
@@ -156,36 +722,92 @@ void AVRCharacter::MoveRight(float Throttle)
 
 void AVRCharacter::BeginTeleport()
 {
-	UE_LOG(LogTemp, Display, TEXT("Teleport requested to %s"), *DestinationMarker->GetComponentLocation().ToString());
+	SessionRecorder.AddEvent(EVRInputEvents::Teleport);
+	UE_LOG(LogVRLocomotion, Verbose, TEXT("Teleport requested to %s"), *DestinationMarker->GetComponentLocation().ToString());
 	// only teleport if marker is at a valid location
-	if (DestinationMarker->IsVisible())
+	if (DestinationMarker->IsVisible() && !bTeleportPending)
 	{
+		bTeleportPending = true;
+		PendingTeleportLocation = DestinationMarker->GetComponentLocation();
+		TeleportWaitStartTime = -1.f;
 		StartFade(0, 1);
 
-		FTimerHandle Handle;
-		GetWorldTimerManager().SetTimer(Handle, this, &AVRCharacter::FinishTeleport, FadeInDuration);
+		// Start streaming the destination in while the view fades out
+		TeleportPrefetch.Begin(GetWorld(), PendingTeleportLocation, FadeInDuration + MaxTeleportStreamingWait);
+
+		GetWorldTimerManager().SetTimer(TeleportTimerHandle, this, &AVRCharacter::FinishTeleport, FadeInDuration);
 	}
 }
 
 void AVRCharacter::FinishTeleport()
 {
-	FVector DestinationLocation = DestinationMarker->GetComponentLocation();
+	// Stay faded out until the destination has streamed in, or we've waited long enough
+	const float Now = GetWorld()->GetRealTimeSeconds();
+	if (TeleportWaitStartTime < 0.f)
+	{
+		TeleportWaitStartTime = Now;
+	}
+	const float WaitSeconds = Now - TeleportWaitStartTime;
+	const bool bResident = TeleportPrefetch.IsResident();
+	if (!bResident && WaitSeconds < MaxTeleportStreamingWait)
+	{
+		GetWorldTimerManager().SetTimer(TeleportTimerHandle, this, &AVRCharacter::FinishTeleport, TeleportStreamingPollInterval);
+		return;
+	}
+	TeleportPrefetch.Finish(WaitSeconds, !bResident);
+	bTeleportPending = false;
+
+	FVector DestinationLocation = PendingTeleportLocation;
 	DestinationLocation.Z += GetCapsuleComponent()->GetScaledCapsuleHalfHeight(); // Avoid teleporting player into ground
 	SetActorLocation(DestinationLocation);
-	UE_LOG(LogTemp, Display, TEXT("Teleport performed to %s"), *DestinationLocation.ToString());
+	if (HasAuthority())
+	{
+		RecordTeleport(DestinationLocation);
+	}
+	else
+	{
+		ServerTeleport(DestinationLocation);
+	}
+	UE_LOG(LogVRLocomotion, Log, TEXT("Teleport performed to %s"), *DestinationLocation.ToString());
 
 	StartFade(1, 0);
 }
 
+bool AVRCharacter::ServerTeleport_Validate(FVector_NetQuantize Destination)
+{
+	return !Destination.ContainsNaN();
+}
+
+void AVRCharacter::ServerTeleport_Implementation(FVector_NetQuantize Destination)
+{
+	SetActorLocation(Destination, false, nullptr, ETeleportType::TeleportPhysics);
+	RecordTeleport(Destination);
+}
+
+void AVRCharacter::RecordTeleport(const FVector& Destination)
+{
+	LastTeleport.Destination = Destination;
+	LastTeleport.Count++;
+}
+
+void AVRCharacter::OnRep_LastTeleport()
+{
+	SetActorLocation(LastTeleport.Destination, false, nullptr, ETeleportType::TeleportPhysics);
+
+	// Drop the mesh smoothing offset so the jump isn't blended into a slide
+	GetCharacterMovement()->ResetPredictionData_Client();
+}
+
 void AVRCharacter::UpdateDestinationMarker()
 {
+	VR_LOCOMOTION_SCOPE(STAT_TeleportDestination, TeleportDestination);
+
 	FVector Location;
-	TArray<FVector> PathArray;
-	if (FindTeleportDestination(OUT Location, OUT PathArray))
+	if (FindTeleportDestination(OUT Location, OUT TeleportPathPoints))
 	{
 		DestinationMarker->SetVisibility(true);
 		DestinationMarker->SetWorldLocation(Location);
-		DrawTeleportPath(PathArray);
+		DrawTeleportPath(TeleportPathPoints);
 	}
 	else
 	{
@@ -194,151 +816,179 @@ void AVRCharacter::UpdateDestinationMarker()
 	}
 }
 
-bool AVRCharacter::FindTeleportDestination(FVector& OutLocation, TArray<FVector>& OutPathArray)
+FTeleportArcParams AVRCharacter::MakeTeleportArcParams() const
 {
-	FPredictProjectilePathParams ParabolicParams = {
-	    TeleportProjectileRadius,
-	    LeftController->GetActorLocation(),
-	    LeftController->GetActorForwardVector() * TeleportProjectileSpeed,
-	    5.f,
-	    ECollisionChannel::ECC_Visibility,
-	    this //ignore our own character as a target
-	};
-	// ParabolicParams.DrawDebugType = EDrawDebugTrace::ForOneFrame;
-	ParabolicParams.bTraceComplex = true;
-	FPredictProjectilePathResult ParabolicResult;
+	FTeleportArcParams ArcParams;
+	if (LeftController)
+	{
+		ArcParams.StartLocation = LeftController->GetActorLocation();
+		ArcParams.LaunchVelocity = LeftController->GetActorForwardVector() * TeleportProjectileSpeed;
+	}
+	ArcParams.ProjectileRadius = TeleportProjectileRadius;
+	ArcParams.SimFrequency = TeleportProjectileSimFrequency;
+	ArcParams.MaxSimTime = TeleportProjectileTime;
+	// Proxies are simple shapes, everything else is only accurate per triangle
+	ArcParams.TraceChannel = bTraceTeleportProxies ? ECC_Teleport : ECollisionChannel::ECC_Visibility;
+	ArcParams.bTraceComplex = !bTraceTeleportProxies;
+	ArcParams.IgnoredActor = this; //ignore our own character as a target
+	TeleportArcQuality.Apply(ArcParams);
+	return ArcParams;
+}
 
-	bool bHit = UGameplayStatics::PredictProjectilePath(GetWorld(), ParabolicParams, OUT ParabolicResult);
-	if (!bHit)
+bool AVRCharacter::FindTeleportDestination(FVector& OutLocation, TArray<FVector>& OutPathArray)
+{
+	if (!LeftController)
 	{
 		return false;
 	}
+	const FTeleportArcParams ArcParams = MakeTeleportArcParams();
 
-	// UE_LOG(LogTemp, Display, TEXT("HitResult actor: %s"), *ParabolicResult.HitResult.Actor->GetName())
-	FNavLocation OutNavLocation;
+	// Reuses the last arc while the hand is still, and slices long arcs over several frames
+	if (!TeleportArcPredictor.Update(GetWorld(), ArcParams))
+	{
+		return false;
+	}
 
-	// Project the hit result onto nav mesh plane
-	bool bNav = UNavigationSystemV1::GetCurrent(GetWorld())->ProjectPointToNavigation(ParabolicResult.HitResult.Location, OUT OutNavLocation, TeleportProjectionExtent);
-	if (!bNav)
+	const FTeleportArcResult& ArcResult = TeleportArcPredictor.GetResult();
+	if (!ArcResult.bBlockingHit)
 	{
 		return false;
 	}
-	TArray<FVector> PathArray;
 
-	// Extract from data the path spline
-	for (auto& Point : ParabolicResult.PathData)
+	// Project the hit result onto nav mesh plane, once per predicted arc
+	if (ArcResult.Serial != ProjectedArcSerial)
+	{
+		ProjectedArcSerial = ArcResult.Serial;
+		bProjectedArcOnNavMesh = ProjectTeleportDestination(ArcResult.HitResult.Location, OUT ProjectedArcLocation);
+	}
+	if (!bProjectedArcOnNavMesh)
 	{
-		PathArray.Add(Point.Location);
+		return false;
 	}
-	OutPathArray = PathArray;
 
-	OutLocation = OutNavLocation.Location;
+	// Reset + Append keeps OutPathArray's allocation, where copy assignment would resize it to fit
+	OutPathArray.Reset();
+	OutPathArray.Append(ArcResult.PathPoints);
+	OutLocation = ProjectedArcLocation;
 	return true;
 }
 
-void AVRCharacter::HideTeleportPath()
+bool AVRCharacter::ProjectTeleportDestination(const FVector& HitLocation, FVector& OutLocation)
 {
-	// Hide all meshes
-	for (auto SplineMesh : TeleportPathMeshPool)
+	switch (TeleportReachability.Query(HitLocation, TeleportProjectionExtent, OUT OutLocation))
 	{
-		SplineMesh->SetVisibility(false);
+	case FTeleportReachabilityField::EReachability::Reachable:
+		return true;
+	case FTeleportReachabilityField::EReachability::Unreachable:
+		return false;
+	default:
+		// No baked field here, ask the nav mesh
+		return TeleportNavCache.ProjectPoint(GetWorld(), HitLocation, TeleportProjectionExtent, OUT OutLocation);
 	}
 }
 
+void AVRCharacter::HideTeleportPath()
+{
+	TeleportArc->HideArc();
+}
+
 void AVRCharacter::DrawTeleportPath(const TArray<FVector>& PathArray)
 {
-	TeleportPath->ClearSplinePoints(false);
+	// One instance per segment, all drawn by a single component
+	TeleportArc->SetArcPoints(PathArray);
+}
 
-	// Construct spline
-	for (auto Point : PathArray)
+void AVRCharacter::GripHand(AHandController* Hand, int32 HandIndex)
+{
+	if (Hand && Hand->Grip())
 	{
-		// UE_LOG(LogTemp, Display, TEXT("Spline location: %s"), *Point.ToString());
-		TeleportPath->AddSplinePoint(Point, ESplineCoordinateSpace::World, false);
+		// The other hand keeps its hold, so both hands can climb together
+		ClimbSolver.Grab(HandIndex, Hand->GetActorLocation());
+		GetCharacterMovement()->SetMovementMode(EMovementMode::MOVE_Flying);
 	}
+}
 
-	TeleportPath->UpdateSpline();
-
-	/* 
-	// Udemy method
-	for (int i = 0; i < PathArray.Num() - 1; i++)
+void AVRCharacter::ReleaseHand(AHandController* Hand, int32 HandIndex)
+{
+	if (Hand && Hand->Release())
 	{
-		if (TeleportPathMeshPool.Num() - 1 <= i)
+		ClimbSolver.Release(HandIndex);
+		// If both controllers are not climbing, then make the character fall down
+		if (!ClimbSolver.IsClimbing())
 		{
-			USplineMeshComponent* SplineMesh = NewObject<USplineMeshComponent>(this);
-			SplineMesh->SetMobility(EComponentMobility::Movable);
-			SplineMesh->AttachToComponent(TeleportPath, FAttachmentTransformRules::KeepRelativeTransform);
-			SplineMesh->SetStaticMesh(TeleportArcMesh);
-			SplineMesh->SetMaterial(0, TeleportArcMaterial);
-			SplineMesh->RegisterComponent();
-			SplineMesh->SetVisibility(false);
-			TeleportPathMeshPool.Add(SplineMesh);
+			GetCharacterMovement()->SetMovementMode(EMovementMode::MOVE_Falling);
 		}
-		USplineMeshComponent* SplineMesh = TeleportPathMeshPool[i];
+	}
+}
 
-		FVector StartLocation, StartTangent, EndLocation, EndTangent;
+void AVRCharacter::UpdateCharacterVRRootLocation(float DeltaTime)
+{
+	VR_LOCOMOTION_SCOPE(STAT_VRRootCorrection, VRRootCorrection);
 
-		TeleportPath->GetLocalLocationAndTangentAtSplinePoint(i, OUT StartLocation, OUT StartTangent);
-		TeleportPath->GetLocalLocationAndTangentAtSplinePoint(i + 1, OUT EndLocation, OUT EndTangent);
-		SplineMesh->SetStartAndEnd(StartLocation, StartTangent, EndLocation, EndTangent);
-		SplineMesh->SetVisibility(true);
-	} */
+	FVector NewCameraOffset = GetLatestCameraLocation() - GetActorLocation();
 
-	HideTeleportPath();
+	// Don't want the capsule to move vertically
+	NewCameraOffset.Z = 0;
 
-	// Instantiate new meshes as needed
-	int32 SegmentSize = PathArray.Num() - 1;
-	int32 CurrentPoolSize = TeleportPathMeshPool.Num();
-	if (CurrentPoolSize < SegmentSize)
+	// Climbing carries the camera along with the character, so the camera offset is unaffected by it
+	FVector ClimbOffset = FVector::ZeroVector;
+	if (ClimbSolver.IsClimbing() && LeftController && RightController)
 	{
-		for (int i = 0; i < SegmentSize - CurrentPoolSize; i++)
-		{
-			USplineMeshComponent* SplineMesh = NewObject<USplineMeshComponent>(this);
-			SplineMesh->SetMobility(EComponentMobility::Movable);
-			SplineMesh->AttachToComponent(TeleportPath, FAttachmentTransformRules::KeepRelativeTransform);
-
-			SplineMesh->SetStaticMesh(TeleportArcMesh);
-			SplineMesh->SetMaterial(0, TeleportArcMaterial);
-			SplineMesh->RegisterComponent();
-			SplineMesh->SetVisibility(false);
-			TeleportPathMeshPool.Add(SplineMesh);
-		}
+		const FVector HandLocations[FClimbSolver::MaxHands] = { LeftController->GetActorLocation(), RightController->GetActorLocation() };
+		ClimbOffset = ClimbSolver.Solve(HandLocations, DeltaTime);
 	}
+	SET_DWORD_STAT(STAT_ClimbingHands, ClimbSolver.GetNumGrabbing());
 
-	// Set mesh locations and tangents. Only show used meshes
-	for (int i = 0; i < PathArray.Num() - 1; i++)
+	if (!VRRoot)
 	{
-		USplineMeshComponent* SplineMesh = TeleportPathMeshPool[i];
+		UE_LOG(LogVRLocomotion, Error, TEXT("VRRoot pointer not found for %s"), *GetName());
+		return;
+	}
 
-		FVector StartLocation, StartTangent, EndLocation, EndTangent;
-		TeleportPath->GetLocalLocationAndTangentAtSplinePoint(i, OUT StartLocation, OUT StartTangent);
-		TeleportPath->GetLocalLocationAndTangentAtSplinePoint(i + 1, OUT EndLocation, OUT EndTangent);
+	if (NewCameraOffset.IsNearlyZero() && ClimbOffset.IsNearlyZero())
+	{
+		return;
+	}
 
-		SplineMesh->SetStartAndEnd(StartLocation, StartTangent, EndLocation, EndTangent);
+	// Defer VRRoot's transform propagation until both moves are done. Camera and hands then update once,
+	// and not at all when only the root correction ran, since that leaves VRRoot where it was in the world.
+	FScopedMovementUpdate ScopedVRRootUpdate(VRRoot, EScopedUpdate::DeferredUpdates);
 
-		SplineMesh->SetVisibility(true);
+	if (VRMovement && VRMovement->IsNavWalking())
+	{
+		// Not climbing, since that flies. The capsule follows the head along the nav mesh without sweeping, and the
+		// root only takes back the horizontal part it managed, so stairs lift the view and walls don't push it.
+		const FVector Moved = VRMovement->MoveAlongNavMesh(NewCameraOffset);
+		VRRoot->AddWorldOffset(-FVector(Moved.X, Moved.Y, 0.f));
+		return;
 	}
+
+	// One swept move for room scale and climbing together. A blocked climb is retried next frame, as the
+	// grab points stay where they are.
+	const FVector Delta = NewCameraOffset + ClimbOffset;
+	const FVector StartLocation = GetActorLocation();
+	AddActorWorldOffset(Delta, true);
+
+	// Invert the part of the camera offset the capsule actually made and apply it to VR Root, to prevent a positive
+	// feedback loop. What a wall or ledge blocked stays in VR Root, so the view keeps following the tracked head.
+	const float MovedFraction = Delta.IsNearlyZero() ? 1.f
+		: FMath::Clamp(FVector::DotProduct(GetActorLocation() - StartLocation, Delta) / Delta.SizeSquared(), 0.f, 1.f);
+	VRRoot->AddWorldOffset(-NewCameraOffset * MovedFraction);
 }
 
-void AVRCharacter::UpdateCharacterVRRootLocation()
+FVector AVRCharacter::GetLatestCameraLocation() const
 {
-	FVector NewCameraOffset = Camera->GetComponentLocation() - GetActorLocation();
-
-	// Don't want the capsule to move vertically
-	NewCameraOffset.Z = 0;
-
-	AddActorWorldOffset(NewCameraOffset);
-
-	// Invert the vector and apply to VR Root to prevent positive feedback loop
-	FVector InvertCameraOffset = -NewCameraOffset;
-
-	// UE_LOG(LogTemp, Display, TEXT("VR Root Translation : %s"), *InvertCameraOffset.ToString());
-	if (!VRRoot)
+	// The camera component only picks up the HMD pose when the view is updated, so ask the HMD directly
+	if (bLateLocomotionUpdate && Camera->bLockToHmd && GEngine && GEngine->XRSystem.IsValid())
 	{
-		UE_LOG(LogTemp, Error, TEXT("VRRoot pointer not found for %s"));
-		return;
+		FQuat HMDOrientation;
+		FVector HMDPosition;
+		if (GEngine->XRSystem->GetCurrentPose(IXRTrackingSystem::HMDDeviceId, OUT HMDOrientation, OUT HMDPosition))
+		{
+			return VRRoot->GetComponentTransform().TransformPosition(HMDPosition);
+		}
 	}
-	VRRoot->AddWorldOffset(InvertCameraOffset);
-	// VRRoot->SetRelativeLocation(NewCameraOffset);
+	return Camera->GetComponentLocation();
 }
 
 void AVRCharacter::StartFade(float FromAlpha, float ToAlpha)
@@ -347,6 +997,7 @@ void AVRCharacter::StartFade(float FromAlpha, float ToAlpha)
 
 	if (PlayerController)
 	{
-		PlayerController->PlayerCameraManager->StartCameraFade(FromAlpha, ToAlpha, FadeInDuration, FLinearColor::Black);
+		// Fading out holds black for as long as the teleport waits on streaming
+		PlayerController->PlayerCameraManager->StartCameraFade(FromAlpha, ToAlpha, FadeInDuration, FLinearColor::Black, false, ToAlpha > 0.f);
 	}
 }
@@ -2,16 +2,28 @@
 
 #pragma once
 
+#include "BlinkerVignette.h"
 #include "Camera/CameraComponent.h"
+#include "ClimbSolver.h"
 #include "Components/PostProcessComponent.h"
-#include "Components/SplineComponent.h"
-#include "Components/SplineMeshComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "GameFramework/PlayerController.h"
 #include "HandController.h"
+#include "HapticsDispatcher.h"
+#include "LocomotionResolution.h"
+#include "LocomotionStartupReport.h"
 #include "Materials/MaterialInstanceDynamic.h"
+#include "TeleportArcComponent.h"
+#include "TeleportArcPredictor.h"
+#include "TeleportArcQuality.h"
+#include "TeleportNavCache.h"
+#include "TeleportPrefetch.h"
+#include "TeleportReachabilityField.h"
+#include "VRMovementComponent.h"
+#include "VRNetPose.h"
+#include "VRSessionRecording.h"
 
 #include "VRCharacter.generated.h"
 
@@ -20,14 +32,22 @@ class ARCHITECTUREEXPLORER_API AVRCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
+	// Drive the private locomotion steps one at a time
+	friend class UVRLocomotionBenchmarkCommandlet;
+	friend class FVRCharacterAimingAllocationTest;
+
 public:
 	// Sets default values for this character's properties
-	AVRCharacter();
+	AVRCharacter(const FObjectInitializer& ObjectInitializer);
 
 protected:
+	virtual void PostInitializeComponents() override;
+
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -35,23 +55,78 @@ public:
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 
+	virtual void PawnClientRestart() override;
+	virtual void UnPossessed() override;
+
+	// Rumble requests of this character's hands, flushed once per tick
+	FHapticsDispatcher& GetHapticsDispatcher() { return HapticsDispatcher; }
+
+	virtual float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
+private: // networking
+	// True for the character this machine's HMD drives, and for any character outside of multiplayer
+	bool IsLocalVRUser() const;
+	void ApplyLocalUserState(bool bLocalUser);
+	FVRNetPose MakeLocalPose() const;
+	void SendLocalPose();
+	void ApplyRemotePose(float DeltaTime);
+	void RecordTeleport(const FVector& Destination);
+	void UpdateNetUpdateFrequency();
+	void LoadTeleportReachability();
+
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void ServerUpdatePose(const FVRNetPose& Pose);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerTeleport(FVector_NetQuantize Destination);
+
+	UFUNCTION()
+	void OnRep_LastTeleport();
+
+	// Head and hands of the owning player, for everyone else
+	UPROPERTY(Replicated)
+	FVRNetPose ReplicatedPose;
+
+	UPROPERTY(ReplicatedUsing = OnRep_LastTeleport)
+	FVRTeleportEvent LastTeleport;
+
+	FVRNetPose LastSentPose;
+	float LastPoseSendTime = 0.f;
+	float NextNetUpdateFrequencyTime = 0.f;
+	bool bLocalUserStateApplied = false;
+	bool bAppliedLocalUser = false;
+
 private: //methods
-	void UpdateCharacterVRRootLocation();
+	void SpawnHandControllers();
+	void WarmUpLocomotion();
+	void UpdateCharacterVRRootLocation(float DeltaTime);
+	FVector GetLatestCameraLocation() const;
 	void StartFade(float FromAlpha, float ToAlpha);
 	void MoveForward(float Throttle);
 	void MoveRight(float Throttle);
-	void GripLeft() { LeftController->Grip(); }
-	void ReleaseLeft() { LeftController->Release(); }
-	void GripRight() { RightController->Grip(); }
-	void ReleaseRight() { RightController->Release(); }
+	void GripLeft() { SessionRecorder.AddEvent(EVRInputEvents::GripLeft); GripHand(LeftController, 0); }
+	void ReleaseLeft() { SessionRecorder.AddEvent(EVRInputEvents::ReleaseLeft); ReleaseHand(LeftController, 0); }
+	void GripRight() { SessionRecorder.AddEvent(EVRInputEvents::GripRight); GripHand(RightController, 1); }
+	void ReleaseRight() { SessionRecorder.AddEvent(EVRInputEvents::ReleaseRight); ReleaseHand(RightController, 1); }
+	void GripHand(AHandController* Hand, int32 HandIndex);
+	void ReleaseHand(AHandController* Hand, int32 HandIndex);
 	void BeginTeleport();
 	void FinishTeleport();
+	FTeleportArcParams MakeTeleportArcParams() const;
 	bool FindTeleportDestination(FVector& OutLocation, TArray<FVector>& PathArray);
+	bool ProjectTeleportDestination(const FVector& HitLocation, FVector& OutLocation);
 	void DrawTeleportPath(const TArray<FVector>& PathArray);
 	void HideTeleportPath();
 	void UpdateDestinationMarker();
+	UFUNCTION()
+	void OnNavigationGenerationFinished(class ANavigationData* NavData);
 	void UpdateBlinker();
-	FVector2D GetBlinkerCenter();
+	void UpdateLocomotionResolution(float DeltaTime);
+	void RecordSessionFrame(float DeltaTime);
+	void ApplyReplayFrame(const FVRRecordedFrame& Frame, bool bApplyInput);
+	void BeginReplayTiming();
+	void AdvanceReplayTiming(float FrameDeltaTime);
+	void EndReplayTiming();
 
 private: //state objects
 	UPROPERTY(VisibleAnywhere)
@@ -66,14 +141,15 @@ private: //state objects
 	UPROPERTY(VisibleAnywhere)
 	USceneComponent* VRRoot;
 
+	// The character movement component. Walks, or nav walks with its bWalkOnNavMesh, unless climbing or falling.
 	UPROPERTY(VisibleAnywhere)
-	USplineComponent* TeleportPath;
+	UVRMovementComponent* VRMovement;
 
 	UPROPERTY(VisibleAnywhere)
 	UStaticMeshComponent* DestinationMarker;
 
 	UPROPERTY(VisibleAnywhere)
-	TArray<USplineMeshComponent*> TeleportPathMeshPool;
+	UTeleportArcComponent* TeleportArc;
 
 	UPROPERTY(VisibleAnywhere)
 	UPostProcessComponent* PostProcessComponent;
@@ -81,6 +157,61 @@ private: //state objects
 	UPROPERTY(VisibleAnywhere)
 	UMaterialInstanceDynamic* BlinkerDynamicMaterial;
 
+	FBlinkerVignette Blinker;
+
+	FHapticsDispatcher HapticsDispatcher;
+
+	FLocomotionResolution LocomotionResolution;
+
+	FVRSessionRecorder SessionRecorder;
+
+	// Drives head, hands and input instead of the HMD, controllers and player while open
+	FVRSessionReplay SessionReplay;
+	int32 ReplayFrame = 0;
+
+	// In game, replays force the recorded frame times through FApp's fixed time step and keep to their pace
+	// in real time. The app's own fixed time step settings are put back when the replay ends.
+	bool bReplayTimed = false;
+	bool bReplayPreviousUseFixedTimeStep = false;
+	double ReplayPreviousFixedDeltaTime = 0.0;
+	double ReplayNextFrameTime = 0.0;
+
+	// vr.PixelDensity when play began, which LocomotionResolution scales
+	float BasePixelDensity = 1.f;
+
+	// Grab points of the left (0) and right (1) hands
+	FClimbSolver ClimbSolver;
+
+	FLocomotionStartupReport StartupReport;
+
+	FTeleportArcPredictor TeleportArcPredictor;
+
+	FTeleportArcQuality TeleportArcQuality;
+
+	// Path handed from FindTeleportDestination to DrawTeleportPath, sized once in BeginPlay
+	TArray<FVector> TeleportPathPoints;
+
+	FTeleportNavCache TeleportNavCache;
+
+	// Baked for the current level by the BakeTeleportReachability commandlet, if it was run
+	FTeleportReachabilityField TeleportReachability;
+
+	// The level has teleport proxies and bUseTeleportProxies is on
+	bool bTraceTeleportProxies = false;
+
+	FTeleportPrefetch TeleportPrefetch;
+
+	// Teleport between BeginTeleport and the end of its fade, including any wait on streaming
+	bool bTeleportPending = false;
+	FVector PendingTeleportLocation;
+	float TeleportWaitStartTime = -1.f;
+	FTimerHandle TeleportTimerHandle;
+
+	// Nav projection of the last arc handed out by TeleportArcPredictor
+	uint32 ProjectedArcSerial = 0;
+	bool bProjectedArcOnNavMesh = false;
+	FVector ProjectedArcLocation;
+
 private: // configuration parameters
 	UPROPERTY(EditAnywhere)
 	UMaterialInterface* BlinkerMaterialBase;
@@ -103,15 +234,142 @@ private: // configuration parameters
 	UPROPERTY(EditAnywhere)
 	float TeleportProjectileTime = 5.f;
 
+	// Projectile steps per second at full quality
+	UPROPERTY(EditAnywhere)
+	float TeleportProjectileSimFrequency = 20.f;
+
+	// Lower the arc's step rate, flight time and sweep radius when frames run close to the target frame time
+	UPROPERTY(EditAnywhere)
+	bool bAdaptiveTeleportQuality = true;
+
+	// Refresh rate of the HMD the arc quality is measured against
+	UPROPERTY(EditAnywhere)
+	float TeleportTargetFrameRate = 90.f;
+
 	UPROPERTY(EditAnywhere)
 	FVector TeleportProjectionExtent = FVector(100.f, 100.f, 100.f);
 
+	// Grid cell (cm) within which teleport hits share one nav mesh projection. Zero projects every hit.
+	UPROPERTY(EditAnywhere)
+	float TeleportNavCacheCellSize = 25.f;
+
+	// Validate destinations against the level's baked reachability field instead of the navigation system, when one exists
+	UPROPERTY(EditAnywhere)
+	bool bUseTeleportReachabilityField = true;
+
+	// Hand movement (cm) that still reuses the last predicted arc
+	UPROPERTY(EditAnywhere)
+	float TeleportPredictionLocationTolerance = 1.f;
+
+	// Hand rotation (degrees) that still reuses the last predicted arc
+	UPROPERTY(EditAnywhere)
+	float TeleportPredictionAngleTolerance = 0.5f;
+
+	// Launch speed change (fraction) that still reuses the last predicted arc
+	UPROPERTY(EditAnywhere)
+	float TeleportPredictionSpeedTolerance = 0.001f;
+
+	// Seconds before a still hand retraces its arc anyway, to notice moving geometry. Zero never expires.
+	UPROPERTY(EditAnywhere)
+	float TeleportPredictionMaxAge = 0.5f;
+
+	// Time per frame the arc sweep may take before it continues on the next frame
+	UPROPERTY(EditAnywhere)
+	float TeleportPredictionBudgetMs = 0.5f;
+
+	// Trace the arc through the async trace queue. Adds one frame of latency; off uses blocking sweeps.
+	UPROPERTY(EditAnywhere)
+	bool bAsyncTeleportTraces = false;
+
+	// Trace the arc against the level's simple teleport proxies on the Teleport channel, when the
+	// GenerateTeleportProxies commandlet was run on it. Off, or without proxies, traces complex visibility collision.
+	// Off until the benchmark's -CompareProxies shows the proxies land arcs where complex collision does.
+	UPROPERTY(EditAnywhere)
+	bool bUseTeleportProxies = false;
+
+	// Lay the arc out in closed form and only sweep the parts whose bounds overlap something
+	UPROPERTY(EditAnywhere)
+	bool bTeleportArcBroadphase = true;
+
+	// How quickly (1/s) climbing catches the body up with the hands. Zero follows the hands exactly.
+	UPROPERTY(EditAnywhere)
+	float ClimbSmoothingSpeed = 0.f;
+
+	// Shortest time (s) between two rumbles on the same hand
+	UPROPERTY(EditAnywhere)
+	float HapticsMinInterval = 0.1f;
+
 	UPROPERTY(EditAnywhere)
 	UCurveFloat* RadiusVsVelocity;
 
+	// Narrow the view with speed to reduce motion sickness
+	UPROPERTY(EditAnywhere)
+	bool bBlinkerEnabled = true;
+
+	// Lower vr.PixelDensity while aiming, teleporting, moving or climbing, and restore it afterwards
+	UPROPERTY(EditAnywhere)
+	bool bLocomotionResolution = true;
+
+	// Speed (cm/s) above which smooth locomotion counts as moving
+	UPROPERTY(EditAnywhere)
+	float LocomotionResolutionMovingSpeed = 10.f;
+
+	// Run locomotion at the end of the frame using the freshest HMD pose, so root correction and climbing
+	// are not a frame behind the view
+	UPROPERTY(EditAnywhere)
+	bool bLateLocomotionUpdate = false;
+
+	// Record head, hands and input to Saved/VRSessions, as -RecordVRSession does. -ReplayVRSession=<file> plays one back
+	// with the recorded frame times.
+	UPROPERTY(EditAnywhere)
+	bool bRecordSession = false;
+
+	// Pose updates per second sent by the owning client
+	UPROPERTY(EditAnywhere)
+	float PoseSendRate = 30.f;
+
+	// Head or hand movement (cm) below which no pose update is sent
+	UPROPERTY(EditAnywhere)
+	float PoseSendTolerance = 0.2f;
+
+	// Poses further than this (cm) from the character are dropped by the server
+	UPROPERTY(EditAnywhere)
+	float MaxPoseDistance = 1000.f;
+
+	// How quickly other players' heads and hands catch up with their replicated poses
+	UPROPERTY(EditAnywhere)
+	float RemotePoseInterpSpeed = 15.f;
+
+	// Viewers within this distance (cm) get full network priority, further ones proportionally less
+	UPROPERTY(EditAnywhere)
+	float NetPriorityNearDistance = 1000.f;
+
+	UPROPERTY(EditAnywhere)
+	float NetPriorityMinScale = 0.2f;
+
+	// Replication rate while another player is within NetPriorityNearDistance. Further away it drops in proportion
+	// to the distance, down to MinNetUpdateFrequency.
+	UPROPERTY(EditAnywhere)
+	float NearNetUpdateFrequency = 30.f;
+
+	// Seconds between updates of the replication rate
+	UPROPERTY(EditAnywhere)
+	float NetUpdateFrequencyInterval = 0.5f;
+
+	// Log warm-up timings and hitches of the first minute of play
+	UPROPERTY(EditAnywhere)
+	bool bStartupReport = true;
+
 	UPROPERTY(EditAnywhere)
 	float FadeInDuration = 0.5f;
 
 	UPROPERTY(EditAnywhere)
 	float FadeOutDuration = 0.5f;
+
+	// Longest time (s) the view stays faded out after a teleport fade, waiting for the destination to stream in
+	UPROPERTY(EditAnywhere)
+	float MaxTeleportStreamingWait = 3.f;
+
+	UPROPERTY(EditAnywhere)
+	float TeleportStreamingPollInterval = 0.1f;
 };
@@ -0,0 +1,520 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VRLocomotionBenchmarkCommandlet.h"
+
+#include "ArchitectureExplorer.h"
+#include "CountingMalloc.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerStart.h"
+#include "HAL/PlatformTime.h"
+#include "HandController.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/Package.h"
+#include "VRCharacter.h"
+#include "VRSessionRecording.h"
+
+namespace
+{
+	const float FrameDeltaTime = 1.f / 90.f;
+
+	// Frames at the start of each pass that are left out of the steady state numbers
+	const int32 WarmUpFrames = 90;
+
+	// Distance (cm) between the reference and broadphase impact points that still counts as the same destination
+	const float ArcMatchTolerance = 1.f;
+
+	// Distance (cm) between the nav projected destinations of complex and proxy traces that still counts as the same
+	const float ProxyDestinationTolerance = 25.f;
+
+	struct FFrameSample
+	{
+		double FrameMs = 0.0;
+		double RootCorrectionUs = 0.0;
+		double FindDestinationUs = 0.0;
+		double DrawPathUs = 0.0;
+		double BlinkerUs = 0.0;
+		uint64 FrameAllocations = 0;
+		uint64 FunctionAllocations = 0;
+		bool bArcVisible = false;
+	};
+
+	double CyclesToMicroseconds(uint64 Cycles)
+	{
+		return FPlatformTime::ToMilliseconds64(Cycles) * 1000.0;
+	}
+
+	TSharedRef<FJsonObject> Summarize(TArray<double> Values)
+	{
+		TSharedRef<FJsonObject> Summary = MakeShared<FJsonObject>();
+		if (Values.Num() == 0)
+		{
+			return Summary;
+		}
+
+		Values.Sort();
+		double Total = 0.0;
+		for (const double Value : Values)
+		{
+			Total += Value;
+		}
+		Summary->SetNumberField(TEXT("mean"), Total / Values.Num());
+		Summary->SetNumberField(TEXT("p50"), Values[Values.Num() / 2]);
+		Summary->SetNumberField(TEXT("p95"), Values[FMath::Min(Values.Num() * 95 / 100, Values.Num() - 1)]);
+		Summary->SetNumberField(TEXT("max"), Values.Last());
+		return Summary;
+	}
+
+	template <typename TGetter>
+	TArray<double> Collect(const TArray<FFrameSample>& Samples, TGetter Getter)
+	{
+		TArray<double> Values;
+		Values.Reserve(Samples.Num());
+		for (int32 Frame = WarmUpFrames; Frame < Samples.Num(); Frame++)
+		{
+			Values.Add(Getter(Samples[Frame]));
+		}
+		return Values;
+	}
+
+	void CountTickFunctions(UWorld* World, int32& OutTickingActors, int32& OutTickingComponents)
+	{
+		OutTickingActors = 0;
+		OutTickingComponents = 0;
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			if (It->PrimaryActorTick.IsTickFunctionRegistered() && It->PrimaryActorTick.IsTickFunctionEnabled())
+			{
+				OutTickingActors++;
+			}
+			for (UActorComponent* Component : It->GetComponents())
+			{
+				if (Component && Component->PrimaryComponentTick.IsTickFunctionRegistered() && Component->PrimaryComponentTick.IsTickFunctionEnabled())
+				{
+					OutTickingComponents++;
+				}
+			}
+		}
+	}
+}
+
+UVRLocomotionBenchmarkCommandlet::UVRLocomotionBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UVRLocomotionBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString MapName = TEXT("/Game/MainMap");
+	FString CharacterClassName = TEXT("/Game/BP_VRCharacter.BP_VRCharacter_C");
+	int32 NumFrames = 5000;
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	FParse::Value(*Params, TEXT("Character="), CharacterClassName);
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+
+	// A recorded session replaces the scripted poses, frame for frame and at its own frame times
+	FString ReplayFilename;
+	FVRSessionReplay Replay;
+	if (FParse::Value(*Params, TEXT("Replay="), ReplayFilename))
+	{
+		if (!Replay.Open(ReplayFilename))
+		{
+			return 1;
+		}
+		NumFrames = Replay.GetNumFrames();
+	}
+	NumFrames = FMath::Max(NumFrames, WarmUpFrames + 1);
+	if (Replay.IsOpen() && Replay.GetNumFrames() < NumFrames)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("%s has %d frames, at least %d are needed"), *ReplayFilename, Replay.GetNumFrames(), NumFrames);
+		return 1;
+	}
+	const bool bFailOnAllocations = FParse::Param(*Params, TEXT("FailOnAllocations"));
+	const bool bCompareArcs = FParse::Param(*Params, TEXT("CompareArcs"));
+	const bool bCompareProxies = FParse::Param(*Params, TEXT("CompareProxies"));
+
+	UClass* CharacterClass = LoadClass<AVRCharacter>(nullptr, *CharacterClassName);
+	if (!CharacterClass)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not load character class %s"), *CharacterClassName);
+		return 1;
+	}
+
+	UWorld* World = LoadGameWorld(MapName);
+	if (!World)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+
+	FVector StartLocation = FVector::ZeroVector;
+	FString StartString;
+	TArray<FString> StartComponents;
+	if (FParse::Value(*Params, TEXT("Start="), StartString) && StartString.ParseIntoArray(StartComponents, TEXT(",")) == 3)
+	{
+		StartLocation = FVector(FCString::Atof(*StartComponents[0]), FCString::Atof(*StartComponents[1]), FCString::Atof(*StartComponents[2]));
+	}
+	else
+	{
+		TActorIterator<APlayerStart> It(World);
+		if (It)
+		{
+			StartLocation = It->GetActorLocation();
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	AVRCharacter* Character = World->SpawnActor<AVRCharacter>(CharacterClass, StartLocation, FRotator::ZeroRotator, SpawnParams);
+	if (!Character || !Character->LeftController || !Character->RightController)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not spawn %s with both hands"), *CharacterClassName);
+		UnloadGameWorld(World);
+		return 1;
+	}
+
+	int32 TickingActors = 0;
+	int32 TickingComponents = 0;
+	CountTickFunctions(World, OUT TickingActors, OUT TickingComponents);
+
+	FCountingMalloc* CountingMalloc = FCountingMalloc::Install();
+
+	TArray<FFrameSample> Samples;
+	Samples.SetNum(NumFrames);
+
+	// Pass 1: whole frames through the world tick, the way the game runs them. A replay is played by the
+	// character itself, input included, exactly as with -ReplayVRSession in game.
+	if (Replay.IsOpen())
+	{
+		Character->SessionReplay.Open(ReplayFilename);
+		Character->ReplayFrame = 0;
+	}
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		FFrameSample& Sample = Samples[Frame];
+		if (!Replay.IsOpen())
+		{
+			ApplyScriptedPose(Character, Frame, NumFrames);
+		}
+		const float DeltaTime = Replay.IsOpen() ? Replay.GetFrame(Frame).DeltaTime : FrameDeltaTime;
+
+		const uint64 StartAllocations = CountingMalloc->GetGameThreadAllocations();
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		World->Tick(LEVELTICK_All, DeltaTime);
+		Sample.FrameMs = CyclesToMicroseconds(FPlatformTime::Cycles64() - StartCycles) / 1000.0;
+		Sample.FrameAllocations = CountingMalloc->GetGameThreadAllocations() - StartAllocations;
+		Sample.bArcVisible = Character->DestinationMarker->IsVisible();
+	}
+
+	Character->SessionReplay.Close();
+
+	// Pass 2: each locomotion step on its own, with the world only advancing time. Replays only move head and hands.
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		FFrameSample& Sample = Samples[Frame];
+		if (Replay.IsOpen())
+		{
+			Character->ApplyReplayFrame(Replay.GetFrame(Frame), false);
+		}
+		else
+		{
+			ApplyScriptedPose(Character, Frame, NumFrames);
+		}
+		const float DeltaTime = Replay.IsOpen() ? Replay.GetFrame(Frame).DeltaTime : FrameDeltaTime;
+		World->Tick(LEVELTICK_TimeOnly, DeltaTime);
+
+		const uint64 StartAllocations = CountingMalloc->GetGameThreadAllocations();
+		uint64 Cycles = FPlatformTime::Cycles64();
+
+		Character->UpdateCharacterVRRootLocation(DeltaTime);
+		Sample.RootCorrectionUs = CyclesToMicroseconds(FPlatformTime::Cycles64() - Cycles);
+
+		Cycles = FPlatformTime::Cycles64();
+		FVector Destination;
+		const bool bHasDestination = Character->FindTeleportDestination(OUT Destination, OUT Character->TeleportPathPoints);
+		Sample.FindDestinationUs = CyclesToMicroseconds(FPlatformTime::Cycles64() - Cycles);
+
+		Cycles = FPlatformTime::Cycles64();
+		if (bHasDestination)
+		{
+			Character->DrawTeleportPath(Character->TeleportPathPoints);
+		}
+		else
+		{
+			Character->HideTeleportPath();
+		}
+		Sample.DrawPathUs = CyclesToMicroseconds(FPlatformTime::Cycles64() - Cycles);
+
+		Cycles = FPlatformTime::Cycles64();
+		Character->UpdateBlinker();
+		Sample.BlinkerUs = CyclesToMicroseconds(FPlatformTime::Cycles64() - Cycles);
+
+		Sample.FunctionAllocations = CountingMalloc->GetGameThreadAllocations() - StartAllocations;
+	}
+
+	CountingMalloc->Uninstall();
+
+	// Steady state allocations of the locomotion steps, which should be zero whether or not a destination was found
+	uint64 AimingAllocations = 0;
+	for (int32 Frame = WarmUpFrames; Frame < NumFrames; Frame++)
+	{
+		AimingAllocations += Samples[Frame].FunctionAllocations;
+	}
+
+	const FString OutputBase = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("VRLocomotion-%s"), *FDateTime::Now().ToString());
+
+	FString Csv = TEXT("frame,frame_ms,root_correction_us,find_destination_us,draw_path_us,blinker_us,frame_allocations,function_allocations,arc_visible\n");
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		const FFrameSample& Sample = Samples[Frame];
+		Csv += FString::Printf(TEXT("%d,%.4f,%.3f,%.3f,%.3f,%.3f,%llu,%llu,%d\n"), Frame, Sample.FrameMs, Sample.RootCorrectionUs, Sample.FindDestinationUs,
+			Sample.DrawPathUs, Sample.BlinkerUs, Sample.FrameAllocations, Sample.FunctionAllocations, Sample.bArcVisible ? 1 : 0);
+	}
+
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetStringField(TEXT("map"), MapName);
+	Json->SetStringField(TEXT("character"), CharacterClassName);
+	Json->SetStringField(TEXT("replay"), ReplayFilename);
+	Json->SetNumberField(TEXT("frames"), NumFrames);
+	Json->SetNumberField(TEXT("warm_up_frames"), WarmUpFrames);
+	Json->SetNumberField(TEXT("ticking_actors"), TickingActors);
+	Json->SetNumberField(TEXT("ticking_components"), TickingComponents);
+	Json->SetObjectField(TEXT("frame_ms"), Summarize(Collect(Samples, [](const FFrameSample& S) { return S.FrameMs; })));
+	Json->SetObjectField(TEXT("root_correction_us"), Summarize(Collect(Samples, [](const FFrameSample& S) { return S.RootCorrectionUs; })));
+	Json->SetObjectField(TEXT("find_destination_us"), Summarize(Collect(Samples, [](const FFrameSample& S) { return S.FindDestinationUs; })));
+	Json->SetObjectField(TEXT("draw_path_us"), Summarize(Collect(Samples, [](const FFrameSample& S) { return S.DrawPathUs; })));
+	Json->SetObjectField(TEXT("blinker_us"), Summarize(Collect(Samples, [](const FFrameSample& S) { return S.BlinkerUs; })));
+	Json->SetObjectField(TEXT("frame_allocations"), Summarize(Collect(Samples, [](const FFrameSample& S) { return double(S.FrameAllocations); })));
+	Json->SetObjectField(TEXT("function_allocations"), Summarize(Collect(Samples, [](const FFrameSample& S) { return double(S.FunctionAllocations); })));
+	Json->SetNumberField(TEXT("aiming_allocations"), double(AimingAllocations));
+	Json->SetNumberField(TEXT("teleport_arc_cache_hit_rate"), Character->TeleportArcPredictor.GetCacheHitRate());
+	Json->SetNumberField(TEXT("teleport_nav_cache_hits"), double(Character->TeleportNavCache.GetHits()));
+	Json->SetNumberField(TEXT("teleport_nav_cache_misses"), double(Character->TeleportNavCache.GetMisses()));
+
+	const int32 ArcMismatches = bCompareArcs ? CompareTeleportArcs(World, Character, NumFrames, *Json) : 0;
+	if (bCompareProxies)
+	{
+		CompareTeleportProxies(World, Character, NumFrames, *Json);
+	}
+
+	FString JsonString;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&JsonString);
+	FJsonSerializer::Serialize(Json, JsonWriter);
+
+	FFileHelper::SaveStringToFile(Csv, *(OutputBase + TEXT(".csv")));
+	FFileHelper::SaveStringToFile(JsonString, *(OutputBase + TEXT(".json")));
+	UE_LOG(LogVRLocomotion, Display, TEXT("VR locomotion benchmark written to %s.csv/.json"), *OutputBase);
+	UE_LOG(LogVRLocomotion, Display, TEXT("%s"), *JsonString);
+
+	UnloadGameWorld(World);
+
+	if (bFailOnAllocations && AimingAllocations > 0)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("%llu game thread allocations while aiming after warm up, expected none"), AimingAllocations);
+		return 1;
+	}
+	if (ArcMismatches > 0)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("%d teleport arcs differ from PredictProjectilePath"), ArcMismatches);
+		return 1;
+	}
+	return 0;
+}
+
+int32 UVRLocomotionBenchmarkCommandlet::CompareTeleportArcs(UWorld* World, AVRCharacter* Character, int32 NumFrames, FJsonObject& OutJson)
+{
+	// Every pose traces a fresh arc in one go
+	FTeleportArcPredictor Broadphase;
+	Broadphase.bBroadphase = true;
+	Broadphase.MaxResultAge = 0.f;
+	Broadphase.FrameBudgetMs = 1000.f;
+
+	int32 Mismatches = 0;
+	uint64 ReferenceQueries = 0;
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		ApplyScriptedPose(Character, Frame, NumFrames);
+		const FTeleportArcParams ArcParams = Character->MakeTeleportArcParams();
+
+		FPredictProjectilePathParams ReferenceParams(ArcParams.ProjectileRadius, ArcParams.StartLocation, ArcParams.LaunchVelocity,
+			ArcParams.MaxSimTime, ArcParams.TraceChannel, const_cast<AActor*>(ArcParams.IgnoredActor));
+		ReferenceParams.SimFrequency = ArcParams.SimFrequency;
+		ReferenceParams.bTraceComplex = ArcParams.bTraceComplex;
+		FPredictProjectilePathResult ReferenceResult;
+		const bool bReferenceHit = UGameplayStatics::PredictProjectilePath(World, ReferenceParams, OUT ReferenceResult);
+		// One sweep per step, and the start point isn't a step
+		ReferenceQueries += FMath::Max(ReferenceResult.PathData.Num() - 1, 0);
+
+		Broadphase.Invalidate();
+		Broadphase.Update(World, ArcParams);
+		const FTeleportArcResult& ArcResult = Broadphase.GetResult();
+
+		const bool bMatches = bReferenceHit == ArcResult.bBlockingHit
+			&& (!bReferenceHit || FVector::Dist(ReferenceResult.HitResult.Location, ArcResult.HitResult.Location) <= ArcMatchTolerance);
+		if (!bMatches)
+		{
+			Mismatches++;
+			UE_LOG(LogVRLocomotion, Warning, TEXT("Frame %d: PredictProjectilePath %s at %s, broadphase %s at %s"), Frame,
+				bReferenceHit ? TEXT("hit") : TEXT("missed"), *ReferenceResult.HitResult.Location.ToString(),
+				ArcResult.bBlockingHit ? TEXT("hit") : TEXT("missed"), *ArcResult.HitResult.Location.ToString());
+		}
+	}
+
+	OutJson.SetNumberField(TEXT("arc_comparisons"), NumFrames);
+	OutJson.SetNumberField(TEXT("arc_mismatches"), Mismatches);
+	OutJson.SetNumberField(TEXT("arc_reference_queries"), double(ReferenceQueries));
+	OutJson.SetNumberField(TEXT("arc_broadphase_queries"), double(Broadphase.GetPhysicsQueries()));
+	return Mismatches;
+}
+
+void UVRLocomotionBenchmarkCommandlet::CompareTeleportProxies(UWorld* World, AVRCharacter* Character, int32 NumFrames, FJsonObject& OutJson)
+{
+	TArray<AActor*> ProxyActors;
+	UGameplayStatics::GetAllActorsWithTag(World, TeleportProxyTag, OUT ProxyActors);
+	if (ProxyActors.Num() == 0)
+	{
+		UE_LOG(LogVRLocomotion, Warning, TEXT("The map has no teleport proxies to compare, run GenerateTeleportProxies on it first"));
+		return;
+	}
+
+	// Same predictor settings for both, every pose traced fresh in one go
+	FTeleportArcPredictor Complex;
+	FTeleportArcPredictor Proxy;
+	for (FTeleportArcPredictor* Predictor : { &Complex, &Proxy })
+	{
+		Predictor->bBroadphase = Character->TeleportArcPredictor.bBroadphase;
+		Predictor->MaxResultAge = 0.f;
+		Predictor->FrameBudgetMs = 1000.f;
+	}
+
+	TArray<double> ComplexUs;
+	TArray<double> ProxyUs;
+	TArray<double> DestinationErrors;
+	int32 Mismatches = 0;
+	for (int32 Frame = 0; Frame < NumFrames; Frame++)
+	{
+		ApplyScriptedPose(Character, Frame, NumFrames);
+		FTeleportArcParams ArcParams = Character->MakeTeleportArcParams();
+
+		ArcParams.TraceChannel = ECC_Visibility;
+		ArcParams.bTraceComplex = true;
+		Complex.Invalidate();
+		uint64 Cycles = FPlatformTime::Cycles64();
+		Complex.Update(World, ArcParams);
+		ComplexUs.Add(CyclesToMicroseconds(FPlatformTime::Cycles64() - Cycles));
+
+		ArcParams.TraceChannel = ECC_Teleport;
+		ArcParams.bTraceComplex = false;
+		Proxy.Invalidate();
+		Cycles = FPlatformTime::Cycles64();
+		Proxy.Update(World, ArcParams);
+		ProxyUs.Add(CyclesToMicroseconds(FPlatformTime::Cycles64() - Cycles));
+
+		// Compare where the player would end up, which is what the proxies have to get right
+		FVector ComplexDestination = FVector::ZeroVector;
+		FVector ProxyDestination = FVector::ZeroVector;
+		const bool bComplexValid = Complex.GetResult().bBlockingHit
+			&& Character->ProjectTeleportDestination(Complex.GetResult().HitResult.Location, OUT ComplexDestination);
+		const bool bProxyValid = Proxy.GetResult().bBlockingHit
+			&& Character->ProjectTeleportDestination(Proxy.GetResult().HitResult.Location, OUT ProxyDestination);
+		if (bComplexValid && bProxyValid)
+		{
+			DestinationErrors.Add(FVector::Dist(ComplexDestination, ProxyDestination));
+		}
+		if (bComplexValid != bProxyValid || (bComplexValid && DestinationErrors.Last() > ProxyDestinationTolerance))
+		{
+			Mismatches++;
+			UE_LOG(LogVRLocomotion, Verbose, TEXT("Frame %d: complex %s at %s, proxies %s at %s"), Frame,
+				bComplexValid ? TEXT("valid") : TEXT("invalid"), *ComplexDestination.ToString(),
+				bProxyValid ? TEXT("valid") : TEXT("invalid"), *ProxyDestination.ToString());
+		}
+	}
+
+	OutJson.SetNumberField(TEXT("proxy_comparisons"), NumFrames);
+	OutJson.SetNumberField(TEXT("proxy_destination_mismatches"), Mismatches);
+	OutJson.SetObjectField(TEXT("proxy_destination_error_cm"), Summarize(DestinationErrors));
+	OutJson.SetObjectField(TEXT("complex_arc_us"), Summarize(ComplexUs));
+	OutJson.SetObjectField(TEXT("proxy_arc_us"), Summarize(ProxyUs));
+	OutJson.SetNumberField(TEXT("complex_arc_queries"), double(Complex.GetPhysicsQueries()));
+	OutJson.SetNumberField(TEXT("proxy_arc_queries"), double(Proxy.GetPhysicsQueries()));
+}
+
+UWorld* UVRLocomotionBenchmarkCommandlet::LoadGameWorld(const FString& MapName)
+{
+	UPackage* Package = LoadPackage(nullptr, *MapName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	World->WorldType = EWorldType::Game;
+	World->AddToRoot();
+	if (!World->bIsWorldInitialized)
+	{
+		World->InitWorld(UWorld::InitializationValues()
+			.AllowAudioPlayback(false)
+			.RequiresHitProxies(false)
+			.CreatePhysicsScene(true)
+			.CreateNavigation(true)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(true)
+			.SetTransactional(false)
+			.CreateFXSystem(false));
+	}
+
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	World->UpdateWorldComponents(true, false);
+
+	FURL URL;
+	World->SetGameMode(URL);
+	World->InitializeActorsForPlay(URL);
+	World->BeginPlay();
+	return World;
+}
+
+void UVRLocomotionBenchmarkCommandlet::UnloadGameWorld(UWorld* World)
+{
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World->RemoveFromRoot();
+}
+
+// Stands for the HMD and motion controllers. Untracked motion controllers keep whatever relative transform they
+// are given, so the scripted poses go through exactly the components the real devices drive.
+void UVRLocomotionBenchmarkCommandlet::ApplyScriptedPose(AVRCharacter* Character, int32 Frame, int32 NumFrames)
+{
+	const float Time = Frame * FrameDeltaTime;
+	const float Progress = float(Frame) / NumFrames;
+
+	// Head: standing still for the first three quarters, then walking around the play area
+	FVector HeadLocation(0.f, 0.f, 170.f);
+	if (Progress >= 0.75f)
+	{
+		HeadLocation += FVector(FMath::Cos(Time * 0.5f), FMath::Sin(Time * 0.5f), 0.f) * 50.f;
+	}
+	Character->Camera->SetRelativeLocationAndRotation(HeadLocation, FRotator(0.f, 10.f * FMath::Sin(Time * 0.3f), 0.f));
+
+	// Left hand aims the teleport arc: held still, then a slow sweep, then a fast one
+	const float YawDegreesPerSecond = Progress < 0.25f ? 0.f : Progress < 0.5f ? 10.f : 240.f;
+	const float PitchDegrees = Progress < 0.25f ? -15.f : -15.f + 10.f * FMath::Sin(Time);
+	Character->LeftController->GetMotionController()->SetRelativeLocationAndRotation(
+		FVector(30.f, -20.f, 120.f), FRotator(PitchDegrees, YawDegreesPerSecond * Time, 0.f));
+
+	Character->RightController->GetMotionController()->SetRelativeLocationAndRotation(
+		FVector(30.f, 20.f, 120.f), FRotator::ZeroRotator);
+}
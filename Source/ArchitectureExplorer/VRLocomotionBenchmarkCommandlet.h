@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "CoreMinimal.h"
+
+#include "VRLocomotionBenchmarkCommandlet.generated.h"
+
+class AVRCharacter;
+class FJsonObject;
+class UWorld;
+
+/**
+ * Headless VR locomotion benchmark. Loads a map as a game world, spawns the VR character and drives it with
+ * scripted head and hand poses (no HMD or controllers needed), then records frame and per-function timings,
+ * game thread allocations and ticking actor/component counts. Results are written as CSV (per frame) and
+ * JSON (summary) to Saved/Benchmarks. -FailOnAllocations returns an error if the locomotion steps allocate on any
+ * frame once warmed up, with or without a destination.
+ *
+ * -CompareArcs replays the same poses through UGameplayStatics::PredictProjectilePath and through the teleport
+ * arc broadphase, and returns an error if any destination differs. Query counts of both go into the JSON.
+ *
+ * -CompareProxies traces the same poses against complex visibility collision and against the map's teleport
+ * proxies (see UGenerateTeleportProxiesCommandlet), and adds the time, queries and nav projected destination
+ * differences of both to the JSON.
+ *
+ * -Replay=<file> drives the character with a session recorded with -RecordVRSession instead of the scripted
+ * poses, at the recorded frame times; the comparisons above keep using the scripted poses.
+ *
+ * Usage: UE4Editor-Cmd ArchitectureExplorer.uproject -run=VRLocomotionBenchmark -nullrhi
+ *            [-Map=/Game/MainMap] [-Character=/Game/BP_VRCharacter.BP_VRCharacter_C] [-Frames=5000] [-Start=X,Y,Z] [-Replay=<file>]
+ *            [-FailOnAllocations] [-CompareArcs] [-CompareProxies]
+ */
+UCLASS()
+class ARCHITECTUREEXPLORER_API UVRLocomotionBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UVRLocomotionBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	// Loads MapName as a game world with its game mode, and begins play
+	static UWorld* LoadGameWorld(const FString& MapName);
+	static void UnloadGameWorld(UWorld* World);
+
+private:
+	void ApplyScriptedPose(AVRCharacter* Character, int32 Frame, int32 NumFrames);
+
+	// Returns the number of poses whose broadphase arc ended somewhere else than PredictProjectilePath's
+	int32 CompareTeleportArcs(UWorld* World, AVRCharacter* Character, int32 NumFrames, FJsonObject& OutJson);
+
+	void CompareTeleportProxies(UWorld* World, AVRCharacter* Character, int32 NumFrames, FJsonObject& OutJson);
+};
@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VRLocomotionBenchmarkCommandlet.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRLocomotionBenchmarkTest, "ArchitectureExplorer.VRLocomotion.Benchmark.NoSteadyStateAllocations",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FVRLocomotionBenchmarkTest::RunTest(const FString& Parameters)
+{
+	// One short scripted run on the main map; the commandlet fails if aiming allocates once warmed up
+	UVRLocomotionBenchmarkCommandlet* Benchmark = NewObject<UVRLocomotionBenchmarkCommandlet>();
+	const int32 Result = Benchmark->Main(TEXT("-Frames=600 -FailOnAllocations"));
+	TestEqual(TEXT("Benchmark result (see the log for allocation counts)"), Result, 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VRMovementComponent.h"
+
+#include "ArchitectureExplorer.h"
+#include "NavigationData.h"
+
+DECLARE_CYCLE_STAT(TEXT("Nav Mesh Room Scale Move"), STAT_NavMeshRoomScaleMove, STATGROUP_VRLocomotion);
+
+UVRMovementComponent::UVRMovementComponent()
+{
+	// The nav mesh already keeps the character out of walls, so nav walking doesn't sweep at all
+	bSweepWhileNavWalking = false;
+
+	// The nav mesh can sit a few cm off the floor and cuts corners on stairs. Project onto the real floor often
+	// enough for a head mounted view, ease in quickly, and accept up to a stair step either way.
+	bProjectNavMeshWalking = true;
+	NavMeshProjectionInterval = 0.05f;
+	NavMeshProjectionInterpSpeed = 20.f;
+	NavMeshProjectionHeightScaleUp = 0.67f;
+	NavMeshProjectionHeightScaleDown = 1.f;
+}
+
+void UVRMovementComponent::InitializeComponent()
+{
+	Super::InitializeComponent();
+
+	if (bWalkOnNavMesh)
+	{
+		// Landing after a climb returns to this too
+		DefaultLandMovementMode = MOVE_NavWalking;
+	}
+}
+
+FVector UVRMovementComponent::MoveAlongNavMesh(const FVector& Delta)
+{
+	VR_LOCOMOTION_SCOPE(STAT_NavMeshRoomScaleMove, NavMeshRoomScaleMove);
+
+	if (!UpdatedComponent || !IsNavWalking())
+	{
+		return FVector::ZeroVector;
+	}
+
+	// Projection clamps the destination to the nav mesh, so walking into a wall stops at its edge
+	const FVector OldLocation = GetActorFeetLocation();
+	FNavLocation NavLocation;
+	if (!FindNavFloor(OldLocation + Delta, OUT NavLocation))
+	{
+		return FVector::ZeroVector;
+	}
+	CachedNavLocation = NavLocation;
+
+	const FVector Move = NavLocation.Location - OldLocation;
+	if (Move.IsNearlyZero())
+	{
+		return FVector::ZeroVector;
+	}
+	FHitResult Hit;
+	SafeMoveUpdatedComponent(Move, UpdatedComponent->GetComponentQuat(), bSweepWhileNavWalking, OUT Hit);
+	return GetActorFeetLocation() - OldLocation;
+}
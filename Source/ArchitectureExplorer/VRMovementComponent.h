@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+#include "VRMovementComponent.generated.h"
+
+/**
+ * Character movement for a slow walking avatar in a static building. With bWalkOnNavMesh the character lands in
+ * nav walking instead of walking, so smooth locomotion follows the nav mesh with no step ups or sweeps, and room
+ * scale drift is moved along the nav mesh the same way (MoveAlongNavMesh). Walls are whatever the nav mesh leaves
+ * out. The nav mesh only approximates floor height, so nav walking projects onto the collision geometry below it a
+ * few times a second and eases toward it, which keeps the view from floating over stairs and ramps. Off by default:
+ * the building's nav mesh has to be built for it. Flying (climbing) and falling are the stock modes.
+ */
+UCLASS()
+class ARCHITECTUREEXPLORER_API UVRMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	UVRMovementComponent();
+
+	virtual void InitializeComponent() override;
+
+	bool IsNavWalking() const { return MovementMode == MOVE_NavWalking; }
+
+	// Moves the character by Delta, kept on the nav mesh, without sweeping. Returns how far it actually moved.
+	// Only valid while nav walking.
+	FVector MoveAlongNavMesh(const FVector& Delta);
+
+private:
+	// Walk on the nav mesh instead of the collision geometry. Falls back to walking where there is no nav mesh.
+	UPROPERTY(EditAnywhere)
+	bool bWalkOnNavMesh = false;
+};
@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VRNetBandwidthCommandlet.h"
+
+#include "ArchitectureExplorer.h"
+#include "Dom/JsonObject.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "VRLocomotionBenchmarkCommandlet.h"
+
+namespace
+{
+	const float ServerDeltaTime = 1.f / 30.f;
+
+	// Seconds the clients get to start up and join
+	const double JoinTimeoutSeconds = 120.0;
+
+	struct FConnectionBytes
+	{
+		int64 StartOut = 0;
+		int64 StartIn = 0;
+		int64 Out = 0;
+		int64 In = 0;
+	};
+
+	void TickServer(UWorld* World)
+	{
+		const double FrameStart = FPlatformTime::Seconds();
+		World->Tick(LEVELTICK_All, ServerDeltaTime);
+		const double Remaining = ServerDeltaTime - (FPlatformTime::Seconds() - FrameStart);
+		if (Remaining > 0.0)
+		{
+			FPlatformProcess::Sleep(float(Remaining));
+		}
+	}
+}
+
+UVRNetBandwidthCommandlet::UVRNetBandwidthCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = true;
+	LogToConsole = true;
+}
+
+int32 UVRNetBandwidthCommandlet::Main(const FString& Params)
+{
+	FString MapName = TEXT("/Game/MainMap");
+	FString ReplayFilename = FPaths::ProjectContentDir() / TEXT("VRSessions/AimSweep.vrsession");
+	int32 NumClients = 4;
+	float Seconds = 10.f;
+	int32 Port = 7777;
+	int64 MaxBytesPerPlayer = 0;
+	FParse::Value(*Params, TEXT("Map="), MapName);
+	FParse::Value(*Params, TEXT("Replay="), ReplayFilename);
+	FParse::Value(*Params, TEXT("Clients="), NumClients);
+	FParse::Value(*Params, TEXT("Seconds="), Seconds);
+	FParse::Value(*Params, TEXT("Port="), Port);
+	FParse::Value(*Params, TEXT("MaxBytesPerPlayer="), MaxBytesPerPlayer);
+	if (NumClients < 1 || Seconds <= 0.f)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Clients and Seconds must be positive"));
+		return 1;
+	}
+	ReplayFilename = FPaths::ConvertRelativePathToFull(ReplayFilename);
+	if (!FPaths::FileExists(ReplayFilename))
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("No VR session to replay at %s"), *ReplayFilename);
+		return 1;
+	}
+
+	UWorld* World = UVRLocomotionBenchmarkCommandlet::LoadGameWorld(MapName);
+	if (!World)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not load map %s"), *MapName);
+		return 1;
+	}
+	FURL ListenURL;
+	ListenURL.Port = Port;
+	if (!World->Listen(ListenURL) || !World->GetNetDriver())
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not listen on port %d"), Port);
+		UVRLocomotionBenchmarkCommandlet::UnloadGameWorld(World);
+		return 1;
+	}
+
+	// Each client is its own game process, which replays the session as its local VR user
+	TArray<FProcHandle> Clients;
+	const FString ProjectFile = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+	for (int32 Client = 0; Client < NumClients; Client++)
+	{
+		const FString ClientParams = FString::Printf(TEXT("\"%s\" 127.0.0.1:%d -game -nullrhi -nosound -unattended -ReplayVRSession=\"%s\" -log=VRNetClient%d.log"),
+			*ProjectFile, Port, *ReplayFilename, Client);
+		FProcHandle Handle = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *ClientParams, true, true, true, nullptr, 0, nullptr, nullptr);
+		if (!Handle.IsValid())
+		{
+			UE_LOG(LogVRLocomotion, Error, TEXT("Could not launch client %d"), Client);
+			break;
+		}
+		Clients.Add(Handle);
+	}
+
+	UNetDriver* NetDriver = World->GetNetDriver();
+	const double JoinDeadline = FPlatformTime::Seconds() + JoinTimeoutSeconds;
+	while (Clients.Num() == NumClients && NetDriver->ClientConnections.Num() < NumClients && FPlatformTime::Seconds() < JoinDeadline)
+	{
+		TickServer(World);
+	}
+
+	const bool bAllJoined = Clients.Num() == NumClients && NetDriver->ClientConnections.Num() >= NumClients;
+	TMap<UNetConnection*, FConnectionBytes> Bytes;
+	double MeasuredSeconds = 0.0;
+	if (bAllJoined)
+	{
+		for (UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			FConnectionBytes& ConnectionBytes = Bytes.Add(Connection);
+			ConnectionBytes.StartOut = Connection->OutTotalBytes;
+			ConnectionBytes.StartIn = Connection->InTotalBytes;
+		}
+
+		const double MeasureStart = FPlatformTime::Seconds();
+		while (FPlatformTime::Seconds() - MeasureStart < Seconds)
+		{
+			TickServer(World);
+		}
+		MeasuredSeconds = FPlatformTime::Seconds() - MeasureStart;
+
+		for (UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			if (FConnectionBytes* ConnectionBytes = Bytes.Find(Connection))
+			{
+				ConnectionBytes->Out = Connection->OutTotalBytes - ConnectionBytes->StartOut;
+				ConnectionBytes->In = Connection->InTotalBytes - ConnectionBytes->StartIn;
+			}
+		}
+	}
+	else
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("%d of %d clients joined within %.0f seconds"), NetDriver->ClientConnections.Num(), NumClients, JoinTimeoutSeconds);
+	}
+
+	for (FProcHandle& Handle : Clients)
+	{
+		FPlatformProcess::TerminateProc(Handle, true);
+		FPlatformProcess::CloseProc(Handle);
+	}
+	UVRLocomotionBenchmarkCommandlet::UnloadGameWorld(World);
+	if (!bAllJoined)
+	{
+		return 1;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> Players;
+	int64 MaxOutPerSecond = 0;
+	int64 TotalOut = 0;
+	for (const TPair<UNetConnection*, FConnectionBytes>& Pair : Bytes)
+	{
+		const int64 OutPerSecond = int64(Pair.Value.Out / MeasuredSeconds);
+		const int64 InPerSecond = int64(Pair.Value.In / MeasuredSeconds);
+		MaxOutPerSecond = FMath::Max(MaxOutPerSecond, OutPerSecond);
+		TotalOut += Pair.Value.Out;
+		TSharedRef<FJsonObject> Player = MakeShared<FJsonObject>();
+		Player->SetNumberField(TEXT("out_bytes_per_second"), double(OutPerSecond));
+		Player->SetNumberField(TEXT("in_bytes_per_second"), double(InPerSecond));
+		Players.Add(MakeShared<FJsonValueObject>(Player));
+		UE_LOG(LogVRLocomotion, Display, TEXT("Player: %lld bytes/s to the client, %lld bytes/s from it"), OutPerSecond, InPerSecond);
+	}
+
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetStringField(TEXT("map"), MapName);
+	Json->SetStringField(TEXT("replay"), ReplayFilename);
+	Json->SetNumberField(TEXT("clients"), NumClients);
+	Json->SetNumberField(TEXT("seconds"), MeasuredSeconds);
+	Json->SetNumberField(TEXT("mean_out_bytes_per_second_per_player"), TotalOut / MeasuredSeconds / NumClients);
+	Json->SetNumberField(TEXT("max_out_bytes_per_second_per_player"), double(MaxOutPerSecond));
+	Json->SetArrayField(TEXT("players"), Players);
+
+	FString JsonString;
+	const TSharedRef<TJsonWriter<>> JsonWriter = TJsonWriterFactory<>::Create(&JsonString);
+	FJsonSerializer::Serialize(Json, JsonWriter);
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("VRNetBandwidth-%s.json"), *FDateTime::Now().ToString());
+	FFileHelper::SaveStringToFile(JsonString, *Filename);
+	UE_LOG(LogVRLocomotion, Display, TEXT("VR net bandwidth written to %s"), *Filename);
+	UE_LOG(LogVRLocomotion, Display, TEXT("%s"), *JsonString);
+
+	if (MaxBytesPerPlayer > 0 && MaxOutPerSecond > MaxBytesPerPlayer)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("%lld bytes/s to one player, at most %lld expected"), MaxOutPerSecond, MaxBytesPerPlayer);
+		return 1;
+	}
+	return 0;
+}
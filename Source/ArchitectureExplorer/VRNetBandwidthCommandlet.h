@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "CoreMinimal.h"
+
+#include "VRNetBandwidthCommandlet.generated.h"
+
+/**
+ * Measures replication bandwidth per VR player. Loads a map as a listening server in this process, launches
+ * Clients game processes (-nullrhi, no HMD needed) that connect to it and replay a recorded session through their
+ * characters, and once all of them have joined, counts each client connection's bytes over Seconds of real time.
+ * Bytes per second per player, in both directions, are logged and written as JSON to Saved/Benchmarks. Returns an
+ * error if a client doesn't join in time, or if a player's outgoing rate exceeds -MaxBytesPerPlayer when given.
+ *
+ * Usage: UE4Editor-Cmd ArchitectureExplorer.uproject -run=VRNetBandwidth [-Map=/Game/MainMap] [-Clients=4]
+ *            [-Seconds=10] [-Port=7777] [-Replay=<file>] [-MaxBytesPerPlayer=<bytes per second>]
+ */
+UCLASS()
+class ARCHITECTUREEXPLORER_API UVRNetBandwidthCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UVRNetBandwidthCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
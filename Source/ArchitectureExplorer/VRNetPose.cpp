@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VRNetPose.h"
+
+uint32 FVRNetPose::PackRotation(const FRotator& Rotation)
+{
+	const uint32 Pitch = FRotator::CompressAxisToShort(Rotation.Pitch) >> 5;
+	const uint32 Yaw = FRotator::CompressAxisToShort(Rotation.Yaw) >> 5;
+	const uint32 Roll = FRotator::CompressAxisToShort(Rotation.Roll) >> 6;
+	return (Pitch << 21) | (Yaw << 10) | Roll;
+}
+
+FRotator FVRNetPose::UnpackRotation(uint32 Packed)
+{
+	return FRotator(
+		FRotator::DecompressAxisFromShort(uint16(((Packed >> 21) & 0x7FF) << 5)),
+		FRotator::DecompressAxisFromShort(uint16(((Packed >> 10) & 0x7FF) << 5)),
+		FRotator::DecompressAxisFromShort(uint16((Packed & 0x3FF) << 6)));
+}
+
+bool FVRNetPose::Equals(const FVRNetPose& Other, float LocationTolerance) const
+{
+	return HeadRotation == Other.HeadRotation
+		&& LeftHandRotation == Other.LeftHandRotation
+		&& RightHandRotation == Other.RightHandRotation
+		&& ClimbFlags == Other.ClimbFlags
+		&& HeadLocation.Equals(Other.HeadLocation, LocationTolerance)
+		&& LeftHandLocation.Equals(Other.LeftHandLocation, LocationTolerance)
+		&& RightHandLocation.Equals(Other.RightHandLocation, LocationTolerance);
+}
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+
+#include "VRNetPose.generated.h"
+
+UENUM()
+enum class EVRClimbFlags : uint8
+{
+	None = 0,
+	LeftHand = 1 << 0,
+	RightHand = 1 << 1,
+};
+ENUM_CLASS_FLAGS(EVRClimbFlags);
+
+/**
+ * Head and hand poses of a VR player, relative to their character. Locations are quantized to a millimetre and
+ * rotations packed into 32 bits each. Members replicate individually, so a still head or hand costs nothing.
+ */
+USTRUCT()
+struct FVRNetPose
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize10 HeadLocation = FVector::ZeroVector;
+
+	UPROPERTY()
+	uint32 HeadRotation = 0;
+
+	UPROPERTY()
+	FVector_NetQuantize10 LeftHandLocation = FVector::ZeroVector;
+
+	UPROPERTY()
+	uint32 LeftHandRotation = 0;
+
+	UPROPERTY()
+	FVector_NetQuantize10 RightHandLocation = FVector::ZeroVector;
+
+	UPROPERTY()
+	uint32 RightHandRotation = 0;
+
+	// EVRClimbFlags
+	UPROPERTY()
+	uint8 ClimbFlags = 0;
+
+	// Pitch and yaw get 11 bits (0.18 degrees), roll gets 10
+	static uint32 PackRotation(const FRotator& Rotation);
+	static FRotator UnpackRotation(uint32 Packed);
+
+	// True when no location moved more than LocationTolerance and nothing else changed
+	bool Equals(const FVRNetPose& Other, float LocationTolerance) const;
+};
+
+// A completed teleport, replicated so other players see a jump instead of a smoothed slide
+USTRUCT()
+struct FVRTeleportEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize Destination = FVector::ZeroVector;
+
+	// Bumped per teleport, so teleporting to the same spot twice still replicates
+	UPROPERTY()
+	uint8 Count = 0;
+};
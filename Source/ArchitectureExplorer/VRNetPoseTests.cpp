@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VRNetPose.h"
+
+#include "Misc/AutomationTest.h"
+#include "UObject/CoreNet.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	// Payload of a full pose update, property headers aside: three room scale locations, three rotations, climb flags
+	const int64 PoseBudgetBits = 256;
+
+	void SerializePose(FArchive& Ar, FVRNetPose& Pose)
+	{
+		bool bSuccess = true;
+		Pose.HeadLocation.NetSerialize(Ar, nullptr, bSuccess);
+		Ar << Pose.HeadRotation;
+		Pose.LeftHandLocation.NetSerialize(Ar, nullptr, bSuccess);
+		Ar << Pose.LeftHandRotation;
+		Pose.RightHandLocation.NetSerialize(Ar, nullptr, bSuccess);
+		Ar << Pose.RightHandRotation;
+		Ar << Pose.ClimbFlags;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVRNetPoseSizeTest, "ArchitectureExplorer.VRLocomotion.VRNetPose.SerializedSize",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FVRNetPoseSizeTest::RunTest(const FString& Parameters)
+{
+	// Standing at the edge of a 4 x 4 m play space, arms stretched out
+	const FRotator HeadRotation(-15.f, 135.f, 3.f);
+	const FRotator LeftRotation(20.f, -60.f, -80.f);
+	const FRotator RightRotation(-35.f, 170.f, 45.f);
+	FVRNetPose Pose;
+	Pose.HeadLocation = FVector(-195.3f, 188.7f, 172.4f);
+	Pose.HeadRotation = FVRNetPose::PackRotation(HeadRotation);
+	Pose.LeftHandLocation = FVector(-230.1f, 120.6f, 131.9f);
+	Pose.LeftHandRotation = FVRNetPose::PackRotation(LeftRotation);
+	Pose.RightHandLocation = FVector(-120.8f, 245.2f, 140.2f);
+	Pose.RightHandRotation = FVRNetPose::PackRotation(RightRotation);
+	Pose.ClimbFlags = uint8(EVRClimbFlags::LeftHand);
+
+	FNetBitWriter Writer(nullptr, 1024);
+	SerializePose(Writer, Pose);
+	const int64 NumBits = Writer.GetNumBits();
+	AddInfo(FString::Printf(TEXT("Full pose payload: %lld bits"), NumBits));
+	TestTrue(*FString::Printf(TEXT("Full pose payload of %lld bits within %lld"), NumBits, PoseBudgetBits), NumBits <= PoseBudgetBits);
+
+	FNetBitReader Reader(nullptr, Writer.GetData(), NumBits);
+	FVRNetPose Received;
+	SerializePose(Reader, Received);
+	TestFalse(TEXT("Reading the pose back"), Reader.IsError());
+	TestTrue(TEXT("Locations survive to a millimetre"), Received.Equals(Pose, 0.051f));
+	TestTrue(TEXT("Head rotation survives"), FVRNetPose::UnpackRotation(Received.HeadRotation).Equals(HeadRotation, 0.4f));
+	TestTrue(TEXT("Left hand rotation survives"), FVRNetPose::UnpackRotation(Received.LeftHandRotation).Equals(LeftRotation, 0.4f));
+	TestTrue(TEXT("Right hand rotation survives"), FVRNetPose::UnpackRotation(Received.RightHandRotation).Equals(RightRotation, 0.4f));
+	return true;
+}
+
+#endif
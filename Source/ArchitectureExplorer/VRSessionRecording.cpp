@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "VRSessionRecording.h"
+
+#include "ArchitectureExplorer.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "VRNetPose.h"
+
+namespace
+{
+	struct FSessionHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint32 FrameSize;
+		uint32 Reserved;
+	};
+
+	// "VRSS"
+	const uint32 SessionMagic = 0x53535256;
+	const uint32 SessionVersion = 1;
+
+	// Millimetres
+	const float LocationScale = 10.f;
+
+	void QuantizeLocation(const FVector& Location, int16 (&OutLocation)[3])
+	{
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			OutLocation[Axis] = int16(FMath::Clamp(FMath::RoundToInt(Location[Axis] * LocationScale), -MAX_int16, int32(MAX_int16)));
+		}
+	}
+}
+
+void FVRRecordedFrame::SetPoses(const FTransform& Head, const FTransform& LeftHand, const FTransform& RightHand)
+{
+	QuantizeLocation(Head.GetLocation(), HeadLocation);
+	QuantizeLocation(LeftHand.GetLocation(), LeftHandLocation);
+	QuantizeLocation(RightHand.GetLocation(), RightHandLocation);
+	HeadRotation = FVRNetPose::PackRotation(Head.Rotator());
+	LeftHandRotation = FVRNetPose::PackRotation(LeftHand.Rotator());
+	RightHandRotation = FVRNetPose::PackRotation(RightHand.Rotator());
+}
+
+FTransform FVRRecordedFrame::MakeTransform(const int16 (&Location)[3], uint32 Rotation)
+{
+	const FVector Translation(Location[0] / LocationScale, Location[1] / LocationScale, Location[2] / LocationScale);
+	return FTransform(FVRNetPose::UnpackRotation(Rotation), Translation);
+}
+
+FVRSessionRecorder::~FVRSessionRecorder()
+{
+	Stop();
+}
+
+bool FVRSessionRecorder::Start(const FString& Filename)
+{
+	Stop();
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not open %s to record the VR session"), *Filename);
+		return false;
+	}
+
+	FSessionHeader Header = { SessionMagic, SessionVersion, sizeof(FVRRecordedFrame), 0 };
+	Writer->Serialize(&Header, sizeof(Header));
+	PendingFrame = FVRRecordedFrame();
+	NumFrames = 0;
+	UE_LOG(LogVRLocomotion, Display, TEXT("Recording VR session to %s"), *Filename);
+	return true;
+}
+
+void FVRSessionRecorder::Stop()
+{
+	if (Writer)
+	{
+		Writer->Close();
+		Writer.Reset();
+		UE_LOG(LogVRLocomotion, Display, TEXT("Recorded %u VR session frames"), NumFrames);
+	}
+}
+
+void FVRSessionRecorder::WriteFrame(float DeltaTime, const FTransform& Head, const FTransform& LeftHand, const FTransform& RightHand)
+{
+	if (!Writer)
+	{
+		return;
+	}
+
+	PendingFrame.DeltaTime = DeltaTime;
+	PendingFrame.SetPoses(Head, LeftHand, RightHand);
+	Writer->Serialize(&PendingFrame, sizeof(PendingFrame));
+	NumFrames++;
+
+	// Axes are sent every frame, actions only when they happen
+	PendingFrame.Events = EVRInputEvents::None;
+}
+
+FString FVRSessionRecorder::MakeFilename()
+{
+	return FPaths::ProjectSavedDir() / TEXT("VRSessions") / FString::Printf(TEXT("VRSession-%s.vrsession"), *FDateTime::Now().ToString());
+}
+
+FVRSessionReplay::~FVRSessionReplay()
+{
+	Close();
+}
+
+bool FVRSessionReplay::Open(const FString& Filename)
+{
+	Close();
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+	if (!MappedFile || MappedFile->GetFileSize() < int64(sizeof(FSessionHeader)))
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not map VR session %s"), *Filename);
+		Close();
+		return false;
+	}
+	MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize(), true));
+	if (!MappedRegion)
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("Could not map VR session %s"), *Filename);
+		Close();
+		return false;
+	}
+
+	const FSessionHeader* Header = reinterpret_cast<const FSessionHeader*>(MappedRegion->GetMappedPtr());
+	if (Header->Magic != SessionMagic || Header->Version != SessionVersion || Header->FrameSize != sizeof(FVRRecordedFrame))
+	{
+		UE_LOG(LogVRLocomotion, Error, TEXT("%s is not a VR session of version %u"), *Filename, SessionVersion);
+		Close();
+		return false;
+	}
+
+	// A session cut short by a crash ends in a partial frame, which is left out
+	NumFrames = int32((MappedRegion->GetMappedSize() - sizeof(FSessionHeader)) / sizeof(FVRRecordedFrame));
+	Frames = reinterpret_cast<const FVRRecordedFrame*>(MappedRegion->GetMappedPtr() + sizeof(FSessionHeader));
+	UE_LOG(LogVRLocomotion, Display, TEXT("Replaying %d VR session frames from %s"), NumFrames, *Filename);
+	return true;
+}
+
+void FVRSessionReplay::Close()
+{
+	Frames = nullptr;
+	NumFrames = 0;
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+
+class FArchive;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// Input actions of one frame, replayed in this order
+enum class EVRInputEvents : uint8
+{
+	None = 0,
+	GripLeft = 1 << 0,
+	ReleaseLeft = 1 << 1,
+	GripRight = 1 << 2,
+	ReleaseRight = 1 << 3,
+	Teleport = 1 << 4,
+};
+ENUM_CLASS_FLAGS(EVRInputEvents);
+
+/**
+ * One recorded frame: head and hand poses relative to the VR root, and that frame's input. Locations are
+ * quantized to a millimetre within 32 m, rotations packed like FVRNetPose, and move axes to 8 bits.
+ */
+struct FVRRecordedFrame
+{
+	float DeltaTime = 0.f;
+	uint32 HeadRotation = 0;
+	uint32 LeftHandRotation = 0;
+	uint32 RightHandRotation = 0;
+	int16 HeadLocation[3] = {};
+	int16 LeftHandLocation[3] = {};
+	int16 RightHandLocation[3] = {};
+	int8 MoveForward = 0;
+	int8 MoveRight = 0;
+	EVRInputEvents Events = EVRInputEvents::None;
+	uint8 Padding = 0;
+
+	void SetPoses(const FTransform& Head, const FTransform& LeftHand, const FTransform& RightHand);
+	FTransform GetHead() const { return MakeTransform(HeadLocation, HeadRotation); }
+	FTransform GetLeftHand() const { return MakeTransform(LeftHandLocation, LeftHandRotation); }
+	FTransform GetRightHand() const { return MakeTransform(RightHandLocation, RightHandRotation); }
+
+	static int8 QuantizeAxis(float Value) { return int8(FMath::Clamp(FMath::RoundToInt(Value * 127.f), -127, 127)); }
+	static float DequantizeAxis(int8 Value) { return Value / 127.f; }
+
+private:
+	static FTransform MakeTransform(const int16 (&Location)[3], uint32 Rotation);
+};
+static_assert(sizeof(FVRRecordedFrame) == 40, "Recorded frames are written as is, changing their layout needs a new file version");
+
+/**
+ * Appends one FVRRecordedFrame per frame to a session file. The file is a small header followed by fixed size
+ * frames, written through a buffered writer, so recording costs one 40 byte copy per frame. Input arrives
+ * through AddEvent/SetMove* during the frame and goes out with the poses in WriteFrame.
+ */
+class FVRSessionRecorder
+{
+public:
+	~FVRSessionRecorder();
+
+	bool Start(const FString& Filename);
+	void Stop();
+	bool IsRecording() const { return Writer.IsValid(); }
+
+	void AddEvent(EVRInputEvents Event) { PendingFrame.Events |= Event; }
+	void SetMoveForward(float Throttle) { PendingFrame.MoveForward = FVRRecordedFrame::QuantizeAxis(Throttle); }
+	void SetMoveRight(float Throttle) { PendingFrame.MoveRight = FVRRecordedFrame::QuantizeAxis(Throttle); }
+
+	void WriteFrame(float DeltaTime, const FTransform& Head, const FTransform& LeftHand, const FTransform& RightHand);
+
+	uint32 GetNumFrames() const { return NumFrames; }
+
+	// Saved/VRSessions/VRSession-<date>.vrsession
+	static FString MakeFilename();
+
+private:
+	TUniquePtr<FArchive> Writer;
+	FVRRecordedFrame PendingFrame;
+	uint32 NumFrames = 0;
+};
+
+/**
+ * Reads a session file written by FVRSessionRecorder. The file is memory mapped and its frames are used in place.
+ */
+class FVRSessionReplay
+{
+public:
+	~FVRSessionReplay();
+
+	bool Open(const FString& Filename);
+	void Close();
+	bool IsOpen() const { return Frames != nullptr; }
+
+	int32 GetNumFrames() const { return NumFrames; }
+	const FVRRecordedFrame& GetFrame(int32 Index) const { check(Index >= 0 && Index < NumFrames); return Frames[Index]; }
+
+private:
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	const FVRRecordedFrame* Frames = nullptr;
+	int32 NumFrames = 0;
+};